@@ -5,6 +5,8 @@
 #ifndef PPM_METADATA_HPP
 #define PPM_METADATA_HPP
 
+#include "binaryio.hpp"
+
 #include <string>
 
 struct PPMMetadata {
@@ -16,4 +18,7 @@ struct PPMMetadata {
 
 PPMMetadata getPPMMetadata(const std::string& filename);
 
+// Metadatos a partir de una cabecera ya leída (p. ej. la de un PPMFile abierto)
+PPMMetadata getPPMMetadata(const PPMHeader& header);
+
 #endif // PPM_METADATA_HPP
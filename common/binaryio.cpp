@@ -1,3 +1,530 @@
 //
 // Created by diego on 20/10/24.
 //
+
+#include "binaryio.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #include <immintrin.h>
+  #define BINARYIO_SSSE3 1
+#elif defined(__ARM_NEON)
+  #include <arm_neon.h>
+  #define BINARYIO_NEON 1
+#endif
+
+// NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+MappedFile::MappedFile(std::string const & filepath) {
+  if (int const descriptor = ::open(filepath.c_str(), O_RDONLY | O_CLOEXEC); descriptor >= 0) {
+    struct stat info{};
+    if (::fstat(descriptor, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+      auto const size = static_cast<size_t>(info.st_size);
+      if (void * const address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+          address != MAP_FAILED) {
+        ::madvise(address, size, MADV_SEQUENTIAL);
+        mapping    = address;
+        mappedSize = size;
+      }
+    }
+    ::close(descriptor);
+    if (mapping != nullptr) { return; }
+  }
+
+  // Fallback: read everything into an owned buffer
+  std::ifstream file(filepath, std::ios::binary);
+  if (!file.is_open()) { throw std::runtime_error("Failed to open the file: " + filepath); }
+  constexpr size_t chunk = size_t{1} << 20U;
+  while (file) {
+    size_t const used = buffer.size();
+    buffer.resize(used + chunk);
+    file.read(reinterpret_cast<char *>(buffer.data() + used), static_cast<std::streamsize>(chunk));
+    buffer.resize(used + static_cast<size_t>(file.gcount()));
+  }
+}
+
+MappedFile::~MappedFile() { unmap(); }
+
+MappedFile::MappedFile(MappedFile && other) noexcept
+  : mapping(std::exchange(other.mapping, nullptr)),
+    mappedSize(std::exchange(other.mappedSize, 0)), buffer(std::move(other.buffer)) { }
+
+MappedFile & MappedFile::operator=(MappedFile && other) noexcept {
+  if (this != &other) {
+    unmap();
+    mapping    = std::exchange(other.mapping, nullptr);
+    mappedSize = std::exchange(other.mappedSize, 0);
+    buffer     = std::move(other.buffer);
+  }
+  return *this;
+}
+
+void MappedFile::unmap() noexcept {
+  if (mapping != nullptr) {
+    ::munmap(mapping, mappedSize);
+    mapping    = nullptr;
+    mappedSize = 0;
+  }
+}
+
+std::span<uint8_t const> MappedFile::bytes() const {
+  if (mapping != nullptr) { return {static_cast<uint8_t const *>(mapping), mappedSize}; }
+  return buffer;
+}
+
+namespace {
+  constexpr uint maxSampleValue = 65535;
+  constexpr uint max8bitValue   = 255;
+  constexpr size_t headerProbe  = 4096;
+
+  // Thrown when the data ends before the header does, so callers can retry with more bytes
+  class TruncatedHeader : public std::runtime_error {
+    public:
+      TruncatedHeader() : std::runtime_error("Error: Cabecera PPM incompleta.") { }
+  };
+
+  bool isPpmSpace(uint8_t const byte) {
+    return byte == ' ' || byte == '\t' || byte == '\n' || byte == '\v' || byte == '\f' ||
+           byte == '\r';
+  }
+
+  // Walks the header token by token, skipping whitespace and comments
+  class HeaderCursor {
+    public:
+      explicit HeaderCursor(std::span<uint8_t const> const bytes) : data(bytes) { }
+
+      std::string token() {
+        while (pos < data.size() && (isPpmSpace(data[pos]) || data[pos] == '#')) {
+          if (data[pos] == '#') {
+            while (pos < data.size() && data[pos] != '\n') { ++pos; }
+          } else {
+            ++pos;
+          }
+        }
+        size_t const start = pos;
+        while (pos < data.size() && !isPpmSpace(data[pos]) && data[pos] != '#') { ++pos; }
+        // A token running into the end of the data may continue past it
+        if (start == pos || pos == data.size()) { throw TruncatedHeader(); }
+        return {data.begin() + static_cast<std::ptrdiff_t>(start),
+                data.begin() + static_cast<std::ptrdiff_t>(pos)};
+      }
+
+      // Decimal value of the next token, or nullopt when it is not a plain number
+      std::optional<size_t> number() {
+        constexpr size_t maxDigits = 18;
+        std::string const text     = token();
+        auto const isDigit = [](char const digit) { return digit >= '0' && digit <= '9'; };
+        if (text.size() > maxDigits || !std::ranges::all_of(text, isDigit)) { return std::nullopt; }
+        return static_cast<size_t>(std::stoull(text));
+      }
+
+      // The single whitespace byte after maxval is not part of the payload
+      [[nodiscard]] size_t payloadStart() const { return pos + 1; }
+
+    private:
+      std::span<uint8_t const> data;
+      size_t pos = 0;
+  };
+} // namespace
+
+size_t PPMHeader::sampleBytes() const { return maxColorValue > max8bitValue ? 2 : 1; }
+
+size_t PPMHeader::payloadBytes() const { return width * height * 3 * sampleBytes(); }
+
+PPMHeader parsePPMHeader(std::span<uint8_t const> const data) {
+  HeaderCursor cursor(data);
+  PPMHeader header;
+  header.magicNumber = cursor.token();
+  if (header.magicNumber != "P6") { throw std::runtime_error("Error: Formato PPM inválido."); }
+
+  std::optional<size_t> const width  = cursor.number();
+  std::optional<size_t> const height = cursor.number();
+  if (!width || !height || *width == 0 || *height == 0) {
+    throw std::runtime_error("Error: Dimensiones inválidas.");
+  }
+  std::optional<size_t> const maxColorValue = cursor.number();
+  if (!maxColorValue || *maxColorValue == 0 || *maxColorValue > maxSampleValue) {
+    throw std::runtime_error("Error: Valor máximo de color fuera de rango.");
+  }
+  header.width         = *width;
+  header.height        = *height;
+  header.maxColorValue = static_cast<uint>(*maxColorValue);
+  header.payloadOffset = cursor.payloadStart();
+  return header;
+}
+
+PPMHeader readPPMHeader(std::string const & filepath) {
+  std::ifstream file(filepath, std::ios::binary);
+  if (!file.is_open()) { throw std::runtime_error("Failed to open the file: " + filepath); }
+  return readPPMHeader(file);
+}
+
+PPMHeader readPPMHeader(std::istream & stream) {
+  std::vector<uint8_t> prefix;
+  // Headers almost always fit in the first probe; long comment blocks just take more reads
+  for (size_t limit = headerProbe;; limit *= 2) {
+    size_t const used = prefix.size();
+    prefix.resize(limit);
+    stream.read(reinterpret_cast<char *>(prefix.data() + used),
+                static_cast<std::streamsize>(limit - used));
+    prefix.resize(used + static_cast<size_t>(stream.gcount()));
+    try {
+      return parsePPMHeader(prefix);
+    } catch (TruncatedHeader const &) {
+      if (!stream) { throw; }
+    }
+  }
+}
+
+PPMFile::PPMFile(std::string const & filepath)
+  : filepath(filepath), file(filepath), parsed(parsePPMHeader(file.bytes())) { }
+
+std::span<uint8_t const> PPMFile::payload() const {
+  std::span<uint8_t const> const bytes = file.bytes();
+  size_t const size                    = parsed.payloadBytes();
+  if (parsed.payloadOffset > bytes.size() || bytes.size() - parsed.payloadOffset < size) {
+    throw std::runtime_error("Failed to read pixel data from: " + filepath);
+  }
+  return bytes.subspan(parsed.payloadOffset, size);
+}
+
+namespace {
+  constexpr size_t rgb         = 3;
+  constexpr size_t vectorBytes = 16;
+  constexpr uint8_t byteShift  = 8;
+
+#if BINARYIO_SSSE3
+  constexpr size_t groupBytes = rgb * vectorBytes; // one group holds 16 bytes of every channel
+  using ShuffleMask = std::array<int8_t, vectorBytes>;
+  // masks[out][in] is the pshufb control that moves bytes of input vector `in` into output `out`
+  using GroupMasks = std::array<std::array<ShuffleMask, rgb>, rgb>;
+
+  // Offset inside an interleaved group of byte `lane` of the channel vector `channel`. Channel
+  // vectors hold host (little-endian) samples, so big-endian files flip the two sample bytes.
+  template <size_t SampleBytes, bool BigEndian>
+  constexpr size_t groupOffset(size_t const channel, size_t const lane) {
+    size_t const sample = lane / SampleBytes;
+    size_t const byte   = BigEndian ? SampleBytes - 1 - (lane % SampleBytes) : lane % SampleBytes;
+    return (((sample * rgb) + channel) * SampleBytes) + byte;
+  }
+
+  constexpr GroupMasks emptyMasks() {
+    GroupMasks masks{};
+    for (auto & row : masks) {
+      for (auto & mask : row) { mask.fill(-1); }
+    }
+    return masks;
+  }
+
+  // Interleaved blocks -> channel vectors
+  template <size_t SampleBytes, bool BigEndian>
+  constexpr GroupMasks gatherMasks() {
+    GroupMasks masks = emptyMasks();
+    for (size_t channel = 0; channel < rgb; ++channel) {
+      for (size_t lane = 0; lane < vectorBytes; ++lane) {
+        size_t const offset = groupOffset<SampleBytes, BigEndian>(channel, lane);
+        masks[channel][offset / vectorBytes][lane] = static_cast<int8_t>(offset % vectorBytes);
+      }
+    }
+    return masks;
+  }
+
+  // Channel vectors -> interleaved blocks
+  template <size_t SampleBytes, bool BigEndian>
+  constexpr GroupMasks scatterMasks() {
+    GroupMasks masks = emptyMasks();
+    for (size_t channel = 0; channel < rgb; ++channel) {
+      for (size_t lane = 0; lane < vectorBytes; ++lane) {
+        size_t const offset = groupOffset<SampleBytes, BigEndian>(channel, lane);
+        masks[offset / vectorBytes][channel][offset % vectorBytes] = static_cast<int8_t>(lane);
+      }
+    }
+    return masks;
+  }
+
+  constexpr GroupMasks gather8    = gatherMasks<1, false>();
+  constexpr GroupMasks gather16BE = gatherMasks<2, true>();
+  constexpr GroupMasks scatter8    = scatterMasks<1, false>();
+  constexpr GroupMasks scatter16BE = scatterMasks<2, true>();
+  constexpr GroupMasks scatter16LE = scatterMasks<2, false>();
+
+  bool hasSsse3() {
+    static bool const supported = __builtin_cpu_supports("ssse3") != 0;
+    return supported;
+  }
+
+  // Three byte streams walked in lockstep, advancing `stride` bytes per group
+  template <typename Byte>
+  struct Streams {
+      std::array<Byte *, rgb> base;
+      size_t stride;
+  };
+
+  // The three 16-byte blocks of consecutive interleaved groups
+  template <typename Byte>
+  Streams<Byte> blockStreams(Byte * const data) {
+    return {.base = {data, data + vectorBytes, data + (2 * vectorBytes)}, .stride = groupBytes};
+  }
+
+  // One 16-byte vector per channel plane and group
+  template <typename Sample>
+  auto planeStreams(std::span<Sample> const red, std::span<Sample> const green,
+                    std::span<Sample> const blue) {
+    using Byte = std::conditional_t<std::is_const_v<Sample>, uint8_t const, uint8_t>;
+    return Streams<Byte>{.base   = {reinterpret_cast<Byte *>(red.data()),
+                                    reinterpret_cast<Byte *>(green.data()),
+                                    reinterpret_cast<Byte *>(blue.data())},
+                         .stride = vectorBytes};
+  }
+
+  // Shuffle controls feeding one output vector, one per input vector
+  struct OutputControl {
+      __m128i from0;
+      __m128i from1;
+      __m128i from2;
+  };
+
+  __attribute__((target("ssse3"))) void shuffleGroups(Streams<uint8_t const> const & input,
+                                                      Streams<uint8_t> const & output,
+                                                      size_t const groups,
+                                                      GroupMasks const & masks) {
+    auto const load = [](uint8_t const * address) {
+      return _mm_loadu_si128(reinterpret_cast<__m128i const *>(address));
+    };
+    auto const loadMask = [](ShuffleMask const & mask) {
+      return _mm_loadu_si128(reinterpret_cast<__m128i const *>(mask.data()));
+    };
+    std::array<OutputControl, rgb> control{};
+    for (size_t out = 0; out < rgb; ++out) {
+      control[out] = {.from0 = loadMask(masks[out][0]),
+                      .from1 = loadMask(masks[out][1]),
+                      .from2 = loadMask(masks[out][2])};
+    }
+    for (size_t group = 0; group < groups; ++group) {
+      __m128i const in0 = load(input.base[0] + (group * input.stride));
+      __m128i const in1 = load(input.base[1] + (group * input.stride));
+      __m128i const in2 = load(input.base[2] + (group * input.stride));
+      for (size_t out = 0; out < rgb; ++out) {
+        __m128i merged = _mm_shuffle_epi8(in0, control[out].from0);
+        merged         = _mm_or_si128(merged, _mm_shuffle_epi8(in1, control[out].from1));
+        merged         = _mm_or_si128(merged, _mm_shuffle_epi8(in2, control[out].from2));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output.base[out] + (group * output.stride)),
+                         merged);
+      }
+    }
+  }
+#endif
+} // namespace
+
+void deinterleave8(std::span<uint8_t const> const src, std::span<uint8_t> const red,
+                   std::span<uint8_t> const green, std::span<uint8_t> const blue) {
+  size_t const pixels = src.size() / rgb;
+  size_t done         = 0;
+#if BINARYIO_SSSE3
+  if (hasSsse3()) {
+    size_t const groups = pixels / vectorBytes;
+    shuffleGroups(blockStreams(src.data()), planeStreams(red, green, blue), groups, gather8);
+    done = groups * vectorBytes;
+  }
+#elif BINARYIO_NEON
+  for (; done + vectorBytes <= pixels; done += vectorBytes) {
+    uint8x16x3_t const planes = vld3q_u8(src.data() + (done * rgb));
+    vst1q_u8(red.data() + done, planes.val[0]);
+    vst1q_u8(green.data() + done, planes.val[1]);
+    vst1q_u8(blue.data() + done, planes.val[2]);
+  }
+#endif
+  for (size_t i = done; i < pixels; ++i) {
+    red[i]   = src[(i * rgb)];
+    green[i] = src[(i * rgb) + 1];
+    blue[i]  = src[(i * rgb) + 2];
+  }
+}
+
+namespace {
+  constexpr size_t pixelBytes16 = rgb * sizeof(uint16_t);
+  constexpr size_t lanes16      = vectorBytes / sizeof(uint16_t);
+
+#if BINARYIO_NEON
+  uint16x8_t swapBytes(uint16x8_t const value) {
+    return vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u16(value)));
+  }
+#endif
+} // namespace
+
+void deinterleave16BE(std::span<uint8_t const> const src, std::span<uint16_t> const red,
+                      std::span<uint16_t> const green, std::span<uint16_t> const blue) {
+  size_t const pixels = src.size() / pixelBytes16;
+  size_t done         = 0;
+#if BINARYIO_SSSE3
+  if (hasSsse3()) {
+    size_t const groups = pixels / lanes16;
+    shuffleGroups(blockStreams(src.data()), planeStreams(red, green, blue), groups, gather16BE);
+    done = groups * lanes16;
+  }
+#elif BINARYIO_NEON
+  for (; done + lanes16 <= pixels; done += lanes16) {
+    uint16x8x3_t const planes =
+        vld3q_u16(reinterpret_cast<uint16_t const *>(src.data() + (done * pixelBytes16)));
+    vst1q_u16(red.data() + done, swapBytes(planes.val[0]));
+    vst1q_u16(green.data() + done, swapBytes(planes.val[1]));
+    vst1q_u16(blue.data() + done, swapBytes(planes.val[2]));
+  }
+#endif
+  auto const sample = [&src](size_t const offset) {
+    return static_cast<uint16_t>((src[offset] << byteShift) | src[offset + 1]);
+  };
+  for (size_t i = done; i < pixels; ++i) {
+    red[i]   = sample(i * pixelBytes16);
+    green[i] = sample((i * pixelBytes16) + 2);
+    blue[i]  = sample((i * pixelBytes16) + 4);
+  }
+}
+
+void interleave8(std::span<uint8_t const> const red, std::span<uint8_t const> const green,
+                 std::span<uint8_t const> const blue, std::span<uint8_t> const dst) {
+  size_t const pixels = red.size();
+  size_t done         = 0;
+#if BINARYIO_SSSE3
+  if (hasSsse3()) {
+    size_t const groups = pixels / vectorBytes;
+    shuffleGroups(planeStreams(red, green, blue), blockStreams(dst.data()), groups, scatter8);
+    done = groups * vectorBytes;
+  }
+#elif BINARYIO_NEON
+  for (; done + vectorBytes <= pixels; done += vectorBytes) {
+    uint8x16x3_t const planes = {
+      {vld1q_u8(red.data() + done), vld1q_u8(green.data() + done), vld1q_u8(blue.data() + done)}
+    };
+    vst3q_u8(dst.data() + (done * rgb), planes);
+  }
+#endif
+  for (size_t i = done; i < pixels; ++i) {
+    dst[(i * rgb)]     = red[i];
+    dst[(i * rgb) + 1] = green[i];
+    dst[(i * rgb) + 2] = blue[i];
+  }
+}
+
+namespace {
+  template <bool BigEndian>
+  void interleave16(std::span<uint16_t const> const red, std::span<uint16_t const> const green,
+                    std::span<uint16_t const> const blue, std::span<uint8_t> const dst) {
+    size_t const pixels = red.size();
+    size_t done         = 0;
+#if BINARYIO_SSSE3
+    if (hasSsse3()) {
+      size_t const groups = pixels / lanes16;
+      shuffleGroups(planeStreams(red, green, blue), blockStreams(dst.data()), groups,
+                    BigEndian ? scatter16BE : scatter16LE);
+      done = groups * lanes16;
+    }
+#elif BINARYIO_NEON
+    auto const order = [](uint16x8_t const value) { return BigEndian ? swapBytes(value) : value; };
+    for (; done + lanes16 <= pixels; done += lanes16) {
+      uint16x8x3_t const planes = {
+        {order(vld1q_u16(red.data() + done)), order(vld1q_u16(green.data() + done)),
+         order(vld1q_u16(blue.data() + done))}
+      };
+      vst3q_u16(reinterpret_cast<uint16_t *>(dst.data() + (done * pixelBytes16)), planes);
+    }
+#endif
+    constexpr uint16_t lowByte = 0xFF;
+    auto const store = [&dst](size_t const offset, uint16_t const value) {
+      auto const high = static_cast<uint8_t>(value >> byteShift);
+      auto const low  = static_cast<uint8_t>(value & lowByte);
+      dst[offset]     = BigEndian ? high : low;
+      dst[offset + 1] = BigEndian ? low : high;
+    };
+    for (size_t i = done; i < pixels; ++i) {
+      store(i * pixelBytes16, red[i]);
+      store((i * pixelBytes16) + 2, green[i]);
+      store((i * pixelBytes16) + 4, blue[i]);
+    }
+  }
+} // namespace
+
+void interleave16BE(std::span<uint16_t const> const red, std::span<uint16_t const> const green,
+                    std::span<uint16_t const> const blue, std::span<uint8_t> const dst) {
+  interleave16<true>(red, green, blue, dst);
+}
+
+void interleave16LE(std::span<uint16_t const> const red, std::span<uint16_t const> const green,
+                    std::span<uint16_t const> const blue, std::span<uint8_t> const dst) {
+  interleave16<false>(red, green, blue, dst);
+}
+
+namespace {
+  // Multiple of both pixel sizes so every chunk holds whole pixels
+  constexpr size_t writeChunkBytes = pixelBytes16 << 18U;
+
+  std::span<uint8_t> scratchBuffer() {
+    thread_local std::vector<uint8_t> scratch(writeChunkBytes);
+    return scratch;
+  }
+} // namespace
+
+PPMWriter::PPMWriter(std::string const & filename)
+  : file(filename, std::ios::out | std::ios::binary), name(filename) {
+  if (!file.is_open()) { throw std::runtime_error("Failed to open file for saving: " + filename); }
+}
+
+void PPMWriter::writeHeader(size_t const width, size_t const height, uint const maxColorValue) {
+  file << "P6\n";
+  file << width << " " << height << "\n";
+  file << maxColorValue << "\n";
+}
+
+template <typename Sample, typename Interleave>
+void PPMWriter::writeChunked(std::array<std::span<Sample const>, 3> const & channels,
+                             Interleave interleave) {
+  std::span<uint8_t> const scratch = scratchBuffer();
+  size_t const pixelBytes          = rgb * sizeof(Sample);
+  size_t const chunkPixels         = scratch.size() / pixelBytes;
+  size_t const pixels              = channels[0].size();
+  for (size_t first = 0; first < pixels; first += chunkPixels) {
+    size_t const count = std::min(chunkPixels, pixels - first);
+    auto const out     = scratch.first(count * pixelBytes);
+    interleave(channels[0].subspan(first, count), channels[1].subspan(first, count),
+               channels[2].subspan(first, count), out);
+    writePayload(out);
+  }
+}
+
+void PPMWriter::writePixels8(std::span<uint8_t const> const red,
+                             std::span<uint8_t const> const green,
+                             std::span<uint8_t const> const blue) {
+  writeChunked<uint8_t>({red, green, blue}, interleave8);
+}
+
+void PPMWriter::writePixels16BE(std::span<uint16_t const> const red,
+                                std::span<uint16_t const> const green,
+                                std::span<uint16_t const> const blue) {
+  writeChunked<uint16_t>({red, green, blue}, interleave16BE);
+}
+
+void PPMWriter::writePixels16LE(std::span<uint16_t const> const red,
+                                std::span<uint16_t const> const green,
+                                std::span<uint16_t const> const blue) {
+  writeChunked<uint16_t>({red, green, blue}, interleave16LE);
+}
+
+void PPMWriter::writePayload(std::span<uint8_t const> const bytes) {
+  file.write(reinterpret_cast<char const *>(bytes.data()),
+             static_cast<std::streamsize>(bytes.size()));
+  if (!file) { throw std::runtime_error("Failed to write to: " + name); }
+}
+
+// NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
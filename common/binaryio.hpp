@@ -5,4 +5,118 @@
 #ifndef BINARYIO_HPP
 #define BINARYIO_HPP
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <span>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+// Read-only view over the whole contents of a file. The file is memory-mapped when possible and
+// read into an owned buffer otherwise (pipes, empty files, filesystems without mmap support).
+class MappedFile {
+  public:
+    explicit MappedFile(std::string const & filepath);
+    ~MappedFile();
+
+    MappedFile(MappedFile const &)             = delete;
+    MappedFile & operator=(MappedFile const &) = delete;
+    MappedFile(MappedFile && other) noexcept;
+    MappedFile & operator=(MappedFile && other) noexcept;
+
+    [[nodiscard]] std::span<uint8_t const> bytes() const;
+
+    [[nodiscard]] bool isMapped() const { return mapping != nullptr; }
+
+  private:
+    void * mapping     = nullptr;
+    size_t mappedSize  = 0;
+    std::vector<uint8_t> buffer;
+    void unmap() noexcept;
+};
+
+// Header of a binary (P6) PPM together with the byte offset where its pixel payload starts
+struct PPMHeader {
+    std::string magicNumber;
+    size_t width         = 0;
+    size_t height        = 0;
+    uint maxColorValue   = 0;
+    size_t payloadOffset = 0;
+
+    // Bytes per sample: 1 up to maxval 255, 2 (big-endian) above
+    [[nodiscard]] size_t sampleBytes() const;
+    [[nodiscard]] size_t payloadBytes() const;
+};
+
+// Parse and validate a P6 header. Tokens may be separated by any whitespace and '#' comments; a
+// single whitespace byte after maxval separates the header from the payload.
+PPMHeader parsePPMHeader(std::span<uint8_t const> data);
+
+// Read only as much of the file as the header needs. The stream overload starts at the current
+// position and may read past the header; seek to payloadOffset before reading pixels.
+PPMHeader readPPMHeader(std::string const & filepath);
+PPMHeader readPPMHeader(std::istream & stream);
+
+// A PPM opened once: the parsed header plus a view of the mapped file for the pixel loaders
+class PPMFile {
+  public:
+    explicit PPMFile(std::string const & filepath);
+
+    [[nodiscard]] PPMHeader const & header() const { return parsed; }
+
+    [[nodiscard]] std::string const & path() const { return filepath; }
+
+    // Exactly header().payloadBytes() bytes; throws if the file is shorter
+    [[nodiscard]] std::span<uint8_t const> payload() const;
+
+  private:
+    std::string filepath;
+    MappedFile file;
+    PPMHeader parsed;
+};
+
+// Split an interleaved RGB payload into three channels. Every channel must hold at least
+// src.size() / 3 (8-bit) or src.size() / 6 (16-bit) samples.
+void deinterleave8(std::span<uint8_t const> src, std::span<uint8_t> red, std::span<uint8_t> green,
+                   std::span<uint8_t> blue);
+// 16-bit samples are stored big-endian on disk and converted to host order
+void deinterleave16BE(std::span<uint8_t const> src, std::span<uint16_t> red,
+                      std::span<uint16_t> green, std::span<uint16_t> blue);
+
+// Merge three channels back into an interleaved RGB payload. dst must hold 3 (8-bit) or 6 (16-bit)
+// bytes per sample of red; green and blue must be at least as long as red.
+void interleave8(std::span<uint8_t const> red, std::span<uint8_t const> green,
+                 std::span<uint8_t const> blue, std::span<uint8_t> dst);
+void interleave16BE(std::span<uint16_t const> red, std::span<uint16_t const> green,
+                    std::span<uint16_t const> blue, std::span<uint8_t> dst);
+void interleave16LE(std::span<uint16_t const> red, std::span<uint16_t const> green,
+                    std::span<uint16_t const> blue, std::span<uint8_t> dst);
+
+// Writes a binary PPM. Pixels are interleaved into a per-thread scratch buffer that is reused
+// across calls and flushed to the file in large chunks.
+class PPMWriter {
+  public:
+    explicit PPMWriter(std::string const & filename);
+
+    void writeHeader(size_t width, size_t height, uint maxColorValue);
+    void writePixels8(std::span<uint8_t const> red, std::span<uint8_t const> green,
+                      std::span<uint8_t const> blue);
+    void writePixels16BE(std::span<uint16_t const> red, std::span<uint16_t const> green,
+                         std::span<uint16_t const> blue);
+    void writePixels16LE(std::span<uint16_t const> red, std::span<uint16_t const> green,
+                         std::span<uint16_t const> blue);
+    // Raw, already interleaved payload bytes
+    void writePayload(std::span<uint8_t const> bytes);
+
+  private:
+    std::ofstream file;
+    std::string name;
+    template <typename Sample, typename Interleave>
+    void writeChunked(std::array<std::span<Sample const>, 3> const & channels,
+                      Interleave interleave);
+};
+
 #endif //BINARYIO_HPP
@@ -0,0 +1,76 @@
+#include "colorhistogram.hpp"
+
+#include "threadpool.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+  // Pixels below which a partial histogram (64 MiB of counters to clear and merge) is not worth
+  // another thread
+  constexpr size_t minPartialPixels = size_t{1} << 22U;
+  // Bounds the memory of the partials however many threads the pool has
+  constexpr size_t maxPartials = 8;
+  // Bands of colors the partials are summed in
+  constexpr size_t mergeBands = 64;
+
+  // Histogram of pixels, pixel i having color index indexAt(i)
+  template <typename Count, typename IndexAt>
+  std::vector<Count> countColors(size_t const pixels, IndexAt const & indexAt) {
+    ThreadPool & pool = sharedThreadPool();
+    size_t const parts =
+      std::clamp(pixels / minPartialPixels, size_t{1}, std::min(pool.size(), maxPartials));
+    std::vector<std::vector<Count>> partials(parts);
+    pool.parallelFor(parts, [&](size_t const part) {
+      std::vector<Count> counts(ColorHistogram::colorCount);
+      size_t const end = pixels * (part + 1) / parts;
+      for (size_t pixel = pixels * part / parts; pixel < end; ++pixel) { ++counts[indexAt(pixel)]; }
+      partials[part] = std::move(counts);
+    });
+    if (parts > 1) {
+      size_t const band = ColorHistogram::colorCount / mergeBands;
+      pool.parallelFor(mergeBands, [&](size_t const index) {
+        Count * const total = partials.front().data() + (index * band);
+        for (size_t part = 1; part < parts; ++part) {
+          Count const * const counts = partials[part].data() + (index * band);
+          for (size_t color = 0; color < band; ++color) { total[color] += counts[color]; }
+        }
+      });
+    }
+    return std::move(partials.front());
+  }
+
+  bool needsWideCounts(size_t const pixels) {
+    return pixels > std::numeric_limits<uint32_t>::max();
+  }
+}  // namespace
+
+ColorHistogram::ColorHistogram(Planes8 const & planes) {
+  auto const indexAt = [&planes](size_t const pixel) {
+    return indexOf(planes.red[pixel], planes.green[pixel], planes.blue[pixel]);
+  };
+  size_t const pixels = planes.red.size();
+  if (needsWideCounts(pixels)) {
+    wide = countColors<uint64_t>(pixels, indexAt);
+  } else {
+    narrow = countColors<uint32_t>(pixels, indexAt);
+  }
+}
+
+ColorHistogram::ColorHistogram(std::span<uint8_t const> const pixels) {
+  auto const indexAt = [pixels](size_t const pixel) {
+    return indexOf(pixels[3 * pixel], pixels[(3 * pixel) + 1], pixels[(3 * pixel) + 2]);
+  };
+  size_t const count = pixels.size() / 3;
+  if (needsWideCounts(count)) {
+    wide = countColors<uint64_t>(count, indexAt);
+  } else {
+    narrow = countColors<uint32_t>(count, indexAt);
+  }
+}
+
+size_t ColorHistogram::distinctColors() const {
+  size_t distinct = 0;
+  forEachColor([&distinct](uint32_t, uint64_t) { ++distinct; });
+  return distinct;
+}
@@ -0,0 +1,80 @@
+#ifndef COLORHISTOGRAM_HPP
+#define COLORHISTOGRAM_HPP
+
+#include "simdkernels.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Dense histogram of 8-bit RGB colors: one counter for each of the 2^24 colors, indexed by
+// (red << 16) | (green << 8) | blue. Counting costs one array increment per pixel instead of a
+// hashed insert. Images are split among the shared pool threads, each counting into its own
+// partial histogram, and the partials are then summed in bands of colors in parallel. Counters
+// are 32-bit unless the image has 2^32 pixels or more.
+class ColorHistogram {
+  public:
+    static constexpr size_t colorCount = size_t{1} << 24U;
+
+    static uint32_t indexOf(uint8_t const red, uint8_t const green, uint8_t const blue) {
+      return (uint32_t{red} << 16U) | (uint32_t{green} << 8U) | blue;
+    }
+
+    explicit ColorHistogram(Planes8 const & planes);
+    // Pixels of three interleaved samples
+    explicit ColorHistogram(std::span<uint8_t const> pixels);
+
+    [[nodiscard]] uint64_t count(uint32_t const index) const {
+      return wide.empty() ? narrow[index] : wide[index];
+    }
+
+    // Call visit(pixel, count) at the first pixel of every color, in pixel order, pixel i having
+    // color index indexAt(i). The colors met so far are kept in a bitmap (2 MiB), so the pass
+    // reads each count once and otherwise stays mostly in cache.
+    template <typename IndexAt, typename Visit>
+    void forEachFirstPixel(size_t const pixels, IndexAt const & indexAt,
+                           Visit const & visit) const {
+      std::vector<uint64_t> seen(colorCount / wordBits);
+      uint32_t previous = noColor;
+      for (size_t pixel = 0; pixel < pixels; ++pixel) {
+        uint32_t const index = indexAt(pixel);
+        if (index == previous) { continue; }
+        previous             = index;
+        uint64_t & word      = seen[index / wordBits];
+        uint64_t const mask  = uint64_t{1} << (index % wordBits);
+        if ((word & mask) != 0) { continue; }
+        word |= mask;
+        visit(pixel, count(index));
+      }
+    }
+
+    // Call visit(index, count) for every color with a nonzero count, in increasing index order
+    template <typename Visit>
+    void forEachColor(Visit const & visit) const {
+      if (wide.empty()) {
+        sweep(narrow, visit);
+      } else {
+        sweep(wide, visit);
+      }
+    }
+
+    [[nodiscard]] size_t distinctColors() const;
+
+  private:
+    static constexpr uint32_t wordBits = 64;
+    // Above every color index
+    static constexpr uint32_t noColor = colorCount;
+
+    std::vector<uint32_t> narrow;
+    std::vector<uint64_t> wide;
+
+    template <typename Count, typename Visit>
+    static void sweep(std::vector<Count> const & counts, Visit const & visit) {
+      for (size_t index = 0; index < counts.size(); ++index) {
+        if (counts[index] != 0) { visit(static_cast<uint32_t>(index), uint64_t{counts[index]}); }
+      }
+    }
+};
+
+#endif //COLORHISTOGRAM_HPP
@@ -0,0 +1,71 @@
+#include "colortree.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+  constexpr size_t dimensions = 3;
+
+  uint64_t squaredDistance(ColorKey const & first, ColorKey const & second) {
+    uint64_t distance = 0;
+    for (size_t axis = 0; axis < dimensions; ++axis) {
+      auto const difference = static_cast<int64_t>(first[axis]) - second[axis];
+      distance += static_cast<uint64_t>(difference * difference);
+    }
+    return distance;
+  }
+}  // namespace
+
+ColorTree::ColorTree(std::vector<ColorKey> const & colors) {
+  if (colors.size() > std::numeric_limits<uint32_t>::max()) { throw std::length_error("Too many colors for a ColorTree"); }
+  nodes.reserve(colors.size());
+  for (size_t rank = 0; rank < colors.size(); ++rank) {
+    nodes.push_back(Node{.color = colors[rank], .rank = static_cast<uint32_t>(rank)});
+  }
+  build(Subtree{.first = 0, .end = nodes.size(), .axis = 0});
+}
+
+void ColorTree::build(Subtree const subtree) {
+  auto const [first, end, axis] = subtree;
+  if (end - first <= 1) { return; }
+  size_t const middle = first + ((end - first) / 2);
+  std::nth_element(nodes.begin() + static_cast<std::ptrdiff_t>(first),
+                   nodes.begin() + static_cast<std::ptrdiff_t>(middle),
+                   nodes.begin() + static_cast<std::ptrdiff_t>(end),
+                   [axis](Node const & left, Node const & right) {
+                     return left.color[axis] < right.color[axis];
+                   });
+  size_t const next = (axis + 1) % dimensions;
+  build(Subtree{.first = first, .end = middle, .axis = next});
+  build(Subtree{.first = middle + 1, .end = end, .axis = next});
+}
+
+void ColorTree::search(ColorKey const & target, Subtree const subtree, Best & best) const {
+  auto const [first, end, axis] = subtree;
+  if (first >= end) { return; }
+  size_t const middle     = first + ((end - first) / 2);
+  Node const & node       = nodes[middle];
+  uint64_t const distance = squaredDistance(target, node.color);
+  if (distance < best.distance || (distance == best.distance && node.rank < best.rank)) {
+    best = {.distance = distance, .rank = node.rank};
+  }
+  auto const offset   = static_cast<int64_t>(target[axis]) - node.color[axis];
+  size_t const next   = (axis + 1) % dimensions;
+  Subtree const low   = {.first = first, .end = middle, .axis = next};
+  Subtree const high  = {.first = middle + 1, .end = end, .axis = next};
+  bool const lowFirst = offset < 0;
+  search(target, lowFirst ? low : high, best);
+  // The other side is at least |offset| away; at exactly the best distance it may still hold a
+  // lower ranked color
+  if (static_cast<uint64_t>(offset * offset) <= best.distance) {
+    search(target, lowFirst ? high : low, best);
+  }
+}
+
+size_t ColorTree::nearest(ColorKey const & target) const {
+  if (nodes.empty()) { throw std::logic_error("Nearest color of an empty ColorTree"); }
+  Best best;
+  search(target, Subtree{.first = 0, .end = nodes.size(), .axis = 0}, best);
+  return best.rank;
+}
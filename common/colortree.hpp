@@ -0,0 +1,50 @@
+#ifndef COLORTREE_HPP
+#define COLORTREE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// 8-bit or 16-bit RGB samples
+using ColorKey = std::array<uint16_t, 3>;
+
+// Static k-d tree over a set of colors for exact nearest-color queries under the squared
+// Euclidean distance of cutfreq. The colors are ranked by their position in the list the tree is
+// built from; of several colors at the same distance the lowest ranked one wins, which is the
+// color a linear scan of that list keeping only strictly nearer colors would return.
+class ColorTree {
+  public:
+    explicit ColorTree(std::vector<ColorKey> const & colors);
+
+    // Rank of the color nearest to target; the tree must not be empty
+    [[nodiscard]] size_t nearest(ColorKey const & target) const;
+
+  private:
+    struct Node {
+        ColorKey color;
+        uint32_t rank = 0;
+    };
+
+    struct Best {
+        uint64_t distance = std::numeric_limits<uint64_t>::max();
+        uint32_t rank     = 0;
+    };
+
+    // Nodes [first, end), split on axis at their middle
+    struct Subtree {
+        size_t first = 0;
+        size_t end   = 0;
+        size_t axis  = 0;
+    };
+
+    // Balanced tree stored implicitly: the node of a range sits at its middle and splits it on
+    // axis depth % 3, lower coordinates before it and higher ones after
+    std::vector<Node> nodes;
+
+    void build(Subtree subtree);
+    void search(ColorKey const & target, Subtree subtree, Best & best) const;
+};
+
+#endif //COLORTREE_HPP
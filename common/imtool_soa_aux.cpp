@@ -1,297 +1,650 @@
-//
-// Created by Alberto on 13/11/2024.
-//
-
-#include "imtool_soa_aux.hpp"
-#include "imgsoa/imagesoa.hpp"
-
-#include <iostream>
-#include <optional>
-
-namespace {
-  constexpr int cinco = 5;
-
-  int operationCode(std::string const & operation) {
-    if (typeid(operation) != typeid(std::string)) {
-      std::cerr << "Error: Invalid arguments" << '\n';
-      return -1;
-    }
-    if (operation == "info") { return 0; }
-    if (operation == "maxlevel") { return 1; }
-    if (operation == "resize") { return 2; }
-    if (operation == "cutfreq") { return 3; }
-    if (operation == "compress") { return 4; }
-    std::cerr << "Error: Invalid option: " << operation << '\n';
-    return -1;
-  }
-}  // namespace
-
-int checkProperArgumentNumber(int const operation, size_t argv_size, Command const & cmd) {
-  argv_size -= 1;
-  if (operation == 0 && argv_size != 2) {
-    std::cerr << "Error:  Invalid extra arguments for info:  " << cmd.output << '\n';
-    return 0;
-  }
-  if (operation == 1 && argv_size != 4) {
-    std::cerr << "Error:  Invalid extra arguments for maxlevel:  " << cmd.op2 << '\n';
-    return 0;
-  }
-
-  if (operation == 2 && argv_size != cinco) {
-    std::cerr << "Error:  Invalid extra arguments for resize:  " << cmd.output << '\n';
-    return 0;
-  }
-  if (operation == 3 && argv_size != 4) {
-    std::cerr << "Error:  Invalid extra arguments for cutfreq:  " << cmd.output << '\n';
-    return 0;
-  }
-  return 1;
-}
-
-auto sanitizeArgs(std::vector<std::string> const & args) -> std::optional<Command> {
-  Command cmd{};
-  if (args[2] == "info") {
-    cmd.input     = args[1];
-    cmd.output    = "";
-    cmd.operation = 0;
-  } else {
-    cmd.input     = args[1];
-    cmd.output    = args[2];
-    if (args.size() > 3) {
-      cmd.operation = operationCode(args[3]);
-    } else {
-      cmd.operation = -1;
-    }
-  }
-
-  // Parse optional integer arguments
-  if (args.size() > 4) { cmd.op1 = args[4]; }
-  if (args.size() > cinco) { cmd.op2 = args[cinco]; }
-
-  return cmd;  // Return the successfully parsed command
-}
-
-namespace {
-  void hlpr_handleMaxLevel8bit(PPMMetadata const & metadata, Command const & cmd) {
-    std::string const input  = cmd.input;
-    std::string const output = cmd.output;
-    uint newMax              = 0;
-    try {
-      newMax = static_cast<uint>(std::stoi(cmd.op1));
-    } catch (std::invalid_argument &) {
-      std::cerr << "Error: Invalid maxlevel: " << cmd.op1 << '\n';
-    }
-
-    int const newMaxBitType = numberInXbitRange(newMax);
-    // Create and load 8-bit image
-    auto const image8 = std::make_unique<ImageSOA_8bit>(metadata);
-    image8->loadData(input);
-
-    // Handle scaling based on new max range
-    if (newMaxBitType == ocho) {
-      image8->maxLevel(newMax);
-      image8->saveToFile(output);
-    } else if (newMaxBitType == dieciseis) {
-      // Scale to 16-bit and save
-      auto const image8_16 = image8->maxLevelChangeChannelSize(newMax);
-      image8_16->saveToFile(output);
-    } else {
-      std::cerr << "Rango de newMax no valido.\n";
-    }
-  }
-
-  void hlpr_handleMaxLevel16bit(PPMMetadata const & metadata, Command const & cmd) {
-    std::string const input  = cmd.input;
-    std::string const output = cmd.output;
-    uint newMax              = 0;
-    try {
-      newMax = static_cast<uint>(std::stoi(cmd.op1));
-    } catch (std::invalid_argument &) {
-      std::cerr << "Error: Invalid maxlevel: " << cmd.op1 << '\n';
-    }
-
-    int const newMaxBitType = numberInXbitRange(newMax);
-    // Create and load 8-bit image
-    auto const image16 = std::make_unique<ImageSOA_16bit>(metadata);
-    image16->loadData(input);
-
-    // Handle scaling based on new max range
-    if (newMaxBitType == dieciseis) {
-      image16->maxLevel(newMax);
-      image16->saveToFile(output);
-    } else if (newMaxBitType == ocho) {
-      // Scale to 8-bit and save
-      auto const image16_8 = image16->maxLevelChangeChannelSize(newMax);
-      image16_8->saveToFile(output);
-    } else {
-      std::cerr << "Rango de newMax no valido.\n";
-    }
-  }
-
-  void hlpr_resize8(Command const & cmd, std::string const & input, PPMMetadata const & metadata,
-                    Dimensions const dim) {
-    auto const image8 = std::make_unique<ImageSOA_8bit>(metadata);
-    image8->loadData(input);
-    image8->resize(dim);
-    image8->saveToFile(cmd.output);
-  }
-
-  void hlpr_resize16(Command const & cmd, std::string const & input, PPMMetadata const & metadata,
-                     Dimensions const dim) {
-    auto const image16 = std::make_unique<ImageSOA_16bit>(metadata);
-    image16->loadData(input);
-    image16->resize(dim);
-    image16->saveToFile(cmd.output);
-  }
-}  // namespace
-
-void handleMaxLevel(Command const & cmd) {
-  try {
-    std::string const input = cmd.input;
-
-    switch (PPMMetadata const metadata = loadMetadata(input);
-            numberInXbitRange(metadata.maxColorValue)) {
-      case ocho:
-        hlpr_handleMaxLevel8bit(metadata, cmd);
-        break;
-      case dieciseis:
-        hlpr_handleMaxLevel16bit(metadata, cmd);
-        break;
-      default:
-        std::cerr << "Unsupported image bit type.\n";
-        break;
-    }
-
-  } catch (std::exception const & e) { std::cerr << "Error: " << e.what() << '\n'; }
-}
-
-void handleResize(Command const & cmd) {
-  try {
-    std::string const input    = cmd.input;
-    PPMMetadata const metadata = loadMetadata(input);
-    size_t width               = 0;
-    size_t height              = 0;
-    try {
-      width = static_cast<size_t>(std::stoi(cmd.op1));
-    } catch (std::invalid_argument &) {
-      std::cerr << "Error: Invalid resize width: " << cmd.op1 << '\n';
-    }
-    try {
-      height = static_cast<size_t>(std::stoi(cmd.op2));
-    } catch (std::invalid_argument &) {
-      std::cerr << "Error: Invalid resize height: " << cmd.op2 << '\n';
-    }
-
-    Dimensions const dim = {.width = width, .height = height};
-    switch (numberInXbitRange(metadata.maxColorValue)) {
-      case ocho:
-        {
-          hlpr_resize8(cmd, input, metadata, dim);
-          break;
-        }
-      case dieciseis:
-        {
-          hlpr_resize16(cmd, input, metadata, dim);
-        }
-        break;
-      default:
-        {
-          std::cerr << "Unsupported image bit type.\n";
-        }
-        break;
-    }
-
-  } catch (std::exception const & e) { std::cerr << "Error: " << e.what() << '\n'; }
-}
-
-int handleCutfreq(Command const & cmd) {
-  try {
-    std::string const input    = cmd.input;
-    PPMMetadata const metadata = loadMetadata(input);
-    size_t ncolors             = 0;
-    try {
-      ncolors = static_cast<size_t>(std::stoi(cmd.op1));
-    } catch (std::invalid_argument &) {
-      std::cerr << "Error: Invalid cutfreq: " << cmd.op1 << '\n';
-      return -1;
-    }
-    switch (numberInXbitRange(metadata.maxColorValue)) {
-      case ocho:
-        {
-          auto const image8 = std::make_unique<ImageSOA_8bit>(metadata);
-          image8->loadData(input);
-          image8->reduceColors(ncolors);
-          image8->saveToFile(cmd.output);
-          break;
-        }
-      case dieciseis:
-        {
-          auto const image16 = std::make_unique<ImageSOA_16bit>(metadata);
-          image16->loadData(input);
-          image16->reduceColors(ncolors);
-          image16->saveToFile(cmd.output);
-        }
-        break;
-      default:
-        {
-          std::cerr << "Error: Unsupported image bit type.\n";
-        }
-        break;
-    }
-  } catch (std::exception const & e) {
-    std::cerr << "Error: " << e.what() << '\n';
-    return -1;
-  }
-  return 0;
-}
-
-void handleInfo(Command const & cmd) {
-  std::string const input                                = cmd.input;
-  auto const [magicNumber, width, height, maxColorValue] = loadMetadata(input);
-  std::cout << "Magic Number: " << magicNumber << '\n';
-  std::cout << "Max Color Value: " << maxColorValue << '\n';
-  std::cout << "Image height: " << height << '\n';
-  std::cout << "Image width: " << width << '\n';
-}
-
-int operate(std::vector<std::string> const& arguments, std::optional<Command> const& cmd) {
-  // Check if cmd has a value
-  if (!cmd.has_value()) {
-    std::cerr << "Error: Command is not provided.\n";
-    return -1;
-  }
-
-  // Safe access to cmd
-  switch (cmd->operation) {
-    case 0:
-    {
-      // Info
-      handleInfo(*cmd);
-    }
-    break;
-    case 1:
-    {
-      // Maxlevel
-      handleMaxLevel(*cmd);
-    }
-    break;
-    case 2:
-    {
-      // Resize
-      handleResize(*cmd);
-    }
-    break;
-    case 3:
-    {
-      // Cutfreq
-      handleCutfreq(*cmd);
-    }
-    break;
-    default:
-    {
-      std::cerr << "Error: Invalid option: " << arguments[3] << '\n';
-      return -1;
-    }
-  }
-  return 0;
-}
+//
+// Created by Alberto on 13/11/2024.
+//
+
+#include "imtool_soa_aux.hpp"
+#include "imgsoa/imagesoa.hpp"
+#include "ppmstream.hpp"
+#include "soabatch.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace {
+  constexpr int cinco = 5;
+  constexpr int seis  = 6;
+  // Longer thread counts are rejected before stoul could overflow
+  constexpr size_t maxThreadDigits = 4;
+  // Likewise for pyramid level sizes
+  constexpr size_t maxLevelDigits = 9;
+
+  int operationCode(std::string const & operation) {
+    if (typeid(operation) != typeid(std::string)) {
+      std::cerr << "Error: Invalid arguments" << '\n';
+      return -1;
+    }
+    if (operation == "info") { return 0; }
+    if (operation == "maxlevel") { return 1; }
+    if (operation == "resize") { return 2; }
+    if (operation == "cutfreq") { return 3; }
+    if (operation == "compress") { return 4; }
+    if (operation == "decompress") { return decompressOperation; }
+    if (operation == "pyramid") { return pyramidOperation; }
+    std::cerr << "Error: Invalid option: " << operation << '\n';
+    return -1;
+  }
+}  // namespace
+
+int checkProperArgumentNumber(int const operation, size_t argv_size, Command const & cmd) {
+  argv_size -= 1;
+  if (operation == 0 && argv_size != 2) {
+    std::cerr << "Error:  Invalid extra arguments for info:  " << cmd.output << '\n';
+    return 0;
+  }
+  if (operation == batchOperation && argv_size != 2) {
+    std::cerr << "Error:  Invalid extra arguments for batch:  " << cmd.output << '\n';
+    return 0;
+  }
+  if (operation == 1 && argv_size != 4) {
+    std::cerr << "Error:  Invalid extra arguments for maxlevel:  " << cmd.op2 << '\n';
+    return 0;
+  }
+
+  if (operation == 2 && argv_size != cinco && argv_size != seis) {
+    std::cerr << "Error:  Invalid extra arguments for resize:  " << cmd.output << '\n';
+    return 0;
+  }
+  if (operation == pyramidOperation && argv_size != 4) {
+    std::cerr << "Error:  Invalid extra arguments for pyramid:  " << cmd.output << '\n';
+    return 0;
+  }
+  if (operation == 3 && argv_size != 4) {
+    std::cerr << "Error:  Invalid extra arguments for cutfreq:  " << cmd.output << '\n';
+    return 0;
+  }
+  if ((operation == 4 || operation == decompressOperation) && argv_size != 3) {
+    std::cerr << "Error:  Invalid extra arguments for "
+              << (operation == 4 ? "compress" : "decompress") << ":  " << cmd.op1 << '\n';
+    return 0;
+  }
+  return 1;
+}
+
+auto sanitizeArgs(std::vector<std::string> const & args) -> std::optional<Command> {
+  Command cmd{};
+  if (args[2] == "info") {
+    cmd.input     = args[1];
+    cmd.output    = "";
+    cmd.operation = 0;
+  } else if (args[2] == "batch") {
+    // The input is a manifest with one command per line
+    cmd.input     = args[1];
+    cmd.output    = "";
+    cmd.operation = batchOperation;
+  } else {
+    cmd.input     = args[1];
+    cmd.output    = args[2];
+    if (args.size() > 3) {
+      cmd.operation = operationCode(args[3]);
+    } else {
+      cmd.operation = -1;
+    }
+  }
+
+  // Parse optional integer arguments
+  if (args.size() > 4) { cmd.op1 = args[4]; }
+  if (args.size() > cinco) { cmd.op2 = args[cinco]; }
+  if (args.size() > seis) { cmd.op3 = args[seis]; }
+
+  return cmd;  // Return the successfully parsed command
+}
+
+bool takeThreadsOption(std::vector<std::string> & args) {
+  auto const option = std::ranges::find(args, "--threads");
+  if (option == args.end()) { return true; }
+  if (std::next(option) == args.end()) {
+    std::cerr << "Error: Missing thread count after --threads\n";
+    return false;
+  }
+  std::string const & count = *std::next(option);
+  if (count.empty() || !std::ranges::all_of(count, [](char const digit) {
+        return std::isdigit(static_cast<unsigned char>(digit)) != 0;
+      }) || count.size() > maxThreadDigits || std::stoul(count) == 0) {
+    std::cerr << "Error: Invalid thread count: " << count << '\n';
+    return false;
+  }
+  setSharedThreadCount(std::stoul(count));
+  args.erase(option, std::next(option, 2));
+  return true;
+}
+
+namespace {
+  PPMMetadata metadataOf(PPMFile const & file) { return loadMetadata(file.header()); }
+
+  PPMMetadata metadataOf(CompressedFile const & file) { return loadMetadata(file); }
+
+  std::variant<PPMFile, CompressedFile> openInput(std::string const & path) {
+    if (isCompressedFile(path)) { return CompressedFile(path); }
+    return PPMFile(path);
+  }
+
+  // The input of an operation, opened once: a binary PPM or an image in the compressed format,
+  // which is decoded straight into the channels
+  class InputImage {
+    public:
+      explicit InputImage(std::string const & path) : file(openInput(path)) { }
+
+      [[nodiscard]] PPMMetadata metadata() const {
+        return std::visit([](auto const & opened) { return metadataOf(opened); }, file);
+      }
+
+      // Only set for PPM inputs
+      [[nodiscard]] PPMFile const * ppm() const { return std::get_if<PPMFile>(&file); }
+
+      template <typename Image>
+      [[nodiscard]] std::unique_ptr<Image> load() const {
+        auto image = std::make_unique<Image>(metadata());
+        std::visit([&image](auto const & opened) { image->loadData(opened); }, file);
+        return image;
+      }
+
+    private:
+      std::variant<PPMFile, CompressedFile> file;
+  };
+
+  int hlpr_handleMaxLevel8bit(InputImage const & input, Command const & cmd) {
+    std::string const output = cmd.output;
+    uint newMax              = 0;
+    try {
+      newMax = static_cast<uint>(std::stoi(cmd.op1));
+    } catch (std::invalid_argument &) {
+      std::cerr << "Error: Invalid maxlevel: " << cmd.op1 << '\n';
+      return -1;
+    }
+
+    int const newMaxBitType = numberInXbitRange(newMax);
+    // Create and load 8-bit image
+    auto const image8 = input.load<ImageSOA_8bit>();
+
+    // Handle scaling based on new max range
+    if (newMaxBitType == ocho) {
+      image8->maxLevel(newMax);
+      image8->saveToFile(output);
+    } else if (newMaxBitType == dieciseis) {
+      // Scale to 16-bit and save
+      ImageSOA_16bit image8_16 = std::move(*image8).toSixteenBit(newMax);
+      image8_16.saveToFileBE(output);
+    } else {
+      std::cerr << "Rango de newMax no valido.\n";
+      return -1;
+    }
+    return 0;
+  }
+
+  int hlpr_handleMaxLevel16bit(InputImage const & input, Command const & cmd) {
+    std::string const output = cmd.output;
+    uint newMax              = 0;
+    try {
+      newMax = static_cast<uint>(std::stoi(cmd.op1));
+    } catch (std::invalid_argument &) {
+      std::cerr << "Error: Invalid maxlevel: " << cmd.op1 << '\n';
+      return -1;
+    }
+
+    int const newMaxBitType = numberInXbitRange(newMax);
+    // Create and load 8-bit image
+    auto const image16 = input.load<ImageSOA_16bit>();
+
+    // Handle scaling based on new max range
+    if (newMaxBitType == dieciseis) {
+      image16->maxLevel(newMax);
+      image16->saveToFileBE(output);
+    } else if (newMaxBitType == ocho) {
+      // Scale to 8-bit and save
+      ImageSOA_8bit image16_8 = std::move(*image16).toEightBit(newMax);
+      image16_8.saveToFile(output);
+    } else {
+      std::cerr << "Rango de newMax no valido.\n";
+      return -1;
+    }
+    return 0;
+  }
+
+  // maxlevel maps every sample on its own, so a PPM input is rescaled in one pass from input to
+  // output bytes. Payloads past the streaming threshold are read with block reads rather than
+  // through the mapping.
+  int hlpr_singlePassMaxLevel(Command const & cmd, PPMFile const & ppm) {
+    uint newMax = 0;
+    try {
+      newMax = static_cast<uint>(std::stoi(cmd.op1));
+    } catch (std::invalid_argument &) {
+      std::cerr << "Error: Invalid maxlevel: " << cmd.op1 << '\n';
+      return -1;
+    }
+    if (numberInXbitRange(newMax) == -1) {
+      std::cerr << "Rango de newMax no valido.\n";
+      return -1;
+    }
+    if (ppm.header().payloadBytes() >= streamingThresholdBytes) {
+      streamMaxLevel(StreamJob{.input = cmd.input, .output = cmd.output}, newMax);
+    } else {
+      fusedMaxLevel(ppm, cmd.output, newMax);
+    }
+    return 0;
+  }
+
+  void hlpr_resize8(Command const & cmd, InputImage const & input, Dimensions const dim,
+                    ResizeFilter const filter) {
+    auto const image8 = input.load<ImageSOA_8bit>();
+    image8->sResizeFilter(filter);
+    image8->resize(dim);
+    image8->saveToFile(cmd.output);
+  }
+
+  void hlpr_resize16(Command const & cmd, InputImage const & input, Dimensions const dim,
+                     ResizeFilter const filter) {
+    auto const image16 = input.load<ImageSOA_16bit>();
+    image16->sResizeFilter(filter);
+    image16->resize(dim);
+    image16->saveToFileBE(cmd.output);
+  }
+
+  // Level WxH, or W with the height in proportion to source; nullopt if malformed or empty
+  std::optional<Dimensions> pyramidLevel(std::string const & level, Dimensions const source) {
+    auto const digits = [](std::string const & text) {
+      return !text.empty() && text.size() <= maxLevelDigits &&
+             std::ranges::all_of(text, [](char const digit) {
+               return std::isdigit(static_cast<unsigned char>(digit)) != 0;
+             });
+    };
+    size_t const separator = level.find('x');
+    std::string const width = level.substr(0, separator);
+    if (!digits(width)) { return std::nullopt; }
+    Dimensions dim = {.width = std::stoul(width), .height = 0};
+    if (separator == std::string::npos) {
+      dim.height = ((dim.width * source.height) + (source.width / 2)) / source.width;
+      dim.height = std::max<size_t>(dim.height, 1);
+    } else {
+      std::string const height = level.substr(separator + 1);
+      if (!digits(height)) { return std::nullopt; }
+      dim.height = std::stoul(height);
+    }
+    if (dim.width == 0 || dim.height == 0) { return std::nullopt; }
+    return dim;
+  }
+
+  // The levels of a pyramid, each no larger than the one before, or nullopt after reporting
+  std::optional<std::vector<Dimensions>> pyramidLevels(std::string const & levels,
+                                                       Dimensions const source) {
+    std::vector<Dimensions> result;
+    std::istringstream list(levels);
+    for (std::string level; std::getline(list, level, ',');) {
+      std::optional<Dimensions> const dim = pyramidLevel(level, source);
+      Dimensions const previous           = result.empty() ? source : result.back();
+      if (!dim || dim->width > previous.width || dim->height > previous.height) {
+        std::cerr << "Error: Invalid pyramid levels: " << levels << '\n';
+        return std::nullopt;
+      }
+      result.push_back(*dim);
+    }
+    if (result.empty()) {
+      std::cerr << "Error: Invalid pyramid levels: " << levels << '\n';
+      return std::nullopt;
+    }
+    return result;
+  }
+
+  // output with "-WxH" inserted before the extension of its file name
+  std::string levelPath(std::string const & output, Dimensions const dim) {
+    std::string const suffix =
+      "-" + std::to_string(dim.width) + "x" + std::to_string(dim.height);
+    size_t const name = output.find_last_of('/');
+    size_t const dot  = output.find_last_of('.');
+    if (dot == std::string::npos || (name != std::string::npos && dot < name)) {
+      return output + suffix;
+    }
+    return output.substr(0, dot) + suffix + output.substr(dot);
+  }
+
+  // Levels are computed one after another, each in bands on the shared pool, and then written
+  // concurrently. The source is freed once the first level is built.
+  template <typename Image>
+  void hlpr_pyramid(Command const & cmd, InputImage const & input,
+                    std::vector<Dimensions> const & levels) {
+    std::vector<Image> renditions;
+    renditions.reserve(levels.size());
+    {
+      auto const source = input.load<Image>();
+      source->sResizeFilter(ResizeFilter::box);
+      renditions.push_back(source->resized(levels.front()));
+    }
+    for (size_t level = 1; level < levels.size(); ++level) {
+      renditions.push_back(renditions.back().resized(levels[level]));
+    }
+    sharedThreadPool().parallelFor(renditions.size(), [&](size_t const level) {
+      std::string const path = levelPath(cmd.output, levels[level]);
+      if constexpr (std::is_same_v<Image, ImageSOA_8bit>) {
+        renditions[level].saveToFile(path);
+      } else {
+        renditions[level].saveToFileBE(path);
+      }
+    });
+  }
+}  // namespace
+
+int handleMaxLevel(Command const & cmd) {
+  try {
+    // The file is opened and its header parsed once; loading reuses both
+    InputImage const input(cmd.input);
+
+    // Only compressed inputs are decoded into an image first
+    if (PPMFile const * ppm = input.ppm(); ppm != nullptr) {
+      return hlpr_singlePassMaxLevel(cmd, *ppm);
+    }
+
+    switch (numberInXbitRange(input.metadata().maxColorValue)) {
+      case ocho:
+        return hlpr_handleMaxLevel8bit(input, cmd);
+      case dieciseis:
+        return hlpr_handleMaxLevel16bit(input, cmd);
+      default:
+        std::cerr << "Unsupported image bit type.\n";
+        return -1;
+    }
+
+  } catch (std::exception const & e) {
+    std::cerr << "Error: " << e.what() << '\n';
+    return -1;
+  }
+}
+
+int handleResize(Command const & cmd) {
+  try {
+    InputImage const input(cmd.input);
+    size_t width  = 0;
+    size_t height = 0;
+    try {
+      width = static_cast<size_t>(std::stoi(cmd.op1));
+    } catch (std::invalid_argument &) {
+      std::cerr << "Error: Invalid resize width: " << cmd.op1 << '\n';
+      return -1;
+    }
+    try {
+      height = static_cast<size_t>(std::stoi(cmd.op2));
+    } catch (std::invalid_argument &) {
+      std::cerr << "Error: Invalid resize height: " << cmd.op2 << '\n';
+      return -1;
+    }
+
+    // Without a filter argument resize keeps its bilinear interpolation
+    std::optional<ResizeFilter> const filter =
+      cmd.op3.empty() ? ResizeFilter::bilinear : resizeFilterNamed(cmd.op3);
+    if (!filter) {
+      std::cerr << "Error: Invalid resize filter: " << cmd.op3 << '\n';
+      return -1;
+    }
+
+    Dimensions const dim = {.width = width, .height = height};
+    // Past the streaming threshold a PPM is resized two source rows at a time instead of loaded
+    PPMFile const * ppm = input.ppm();
+    if (ppm != nullptr && *filter == ResizeFilter::bilinear &&
+        ppm->header().payloadBytes() >= streamingThresholdBytes) {
+      streamResize(StreamJob{.input = cmd.input, .output = cmd.output}, dim);
+      return 0;
+    }
+    switch (numberInXbitRange(input.metadata().maxColorValue)) {
+      case ocho:
+        {
+          hlpr_resize8(cmd, input, dim, *filter);
+          break;
+        }
+      case dieciseis:
+        {
+          hlpr_resize16(cmd, input, dim, *filter);
+        }
+        break;
+      default:
+        {
+          std::cerr << "Unsupported image bit type.\n";
+        }
+        return -1;
+    }
+
+  } catch (std::exception const & e) {
+    std::cerr << "Error: " << e.what() << '\n';
+    return -1;
+  }
+  return 0;
+}
+
+int handleCutfreq(Command const & cmd) {
+  try {
+    InputImage const input(cmd.input);
+    size_t ncolors = 0;
+    try {
+      ncolors = static_cast<size_t>(std::stoi(cmd.op1));
+    } catch (std::invalid_argument &) {
+      std::cerr << "Error: Invalid cutfreq: " << cmd.op1 << '\n';
+      return -1;
+    }
+    switch (numberInXbitRange(input.metadata().maxColorValue)) {
+      case ocho:
+        {
+          auto const image8 = input.load<ImageSOA_8bit>();
+          image8->reduceColors(ncolors);
+          image8->saveToFile(cmd.output);
+          break;
+        }
+      case dieciseis:
+        {
+          auto const image16 = input.load<ImageSOA_16bit>();
+          image16->reduceColors(ncolors);
+          image16->saveToFileBE(cmd.output);
+        }
+        break;
+      default:
+        {
+          std::cerr << "Error: Unsupported image bit type.\n";
+        }
+        return -1;
+    }
+  } catch (std::exception const & e) {
+    std::cerr << "Error: " << e.what() << '\n';
+    return -1;
+  }
+  return 0;
+}
+
+int handleCompress(Command const & cmd) {
+  try {
+    InputImage const input(cmd.input);
+    switch (numberInXbitRange(input.metadata().maxColorValue)) {
+      case ocho:
+        {
+          auto const image8 = input.load<ImageSOA_8bit>();
+          image8->compress(cmd.output);
+          break;
+        }
+      case dieciseis:
+        {
+          auto const image16 = input.load<ImageSOA_16bit>();
+          image16->compress(cmd.output);
+          break;
+        }
+      default:
+        {
+          std::cerr << "Error: Unsupported image bit type.\n";
+        }
+        return -1;
+    }
+  } catch (std::exception const & e) {
+    std::cerr << "Error: " << e.what() << '\n';
+    return -1;
+  }
+  return 0;
+}
+
+int handlePyramid(Command const & cmd) {
+  try {
+    InputImage const input(cmd.input);
+    PPMMetadata const metadata = input.metadata();
+    std::optional<std::vector<Dimensions>> const levels =
+      pyramidLevels(cmd.op1, Dimensions{.width = metadata.width, .height = metadata.height});
+    if (!levels) { return -1; }
+    switch (numberInXbitRange(metadata.maxColorValue)) {
+      case ocho:
+        hlpr_pyramid<ImageSOA_8bit>(cmd, input, *levels);
+        break;
+      case dieciseis:
+        hlpr_pyramid<ImageSOA_16bit>(cmd, input, *levels);
+        break;
+      default:
+        std::cerr << "Error: Unsupported image bit type.\n";
+        return -1;
+    }
+  } catch (std::exception const & e) {
+    std::cerr << "Error: " << e.what() << '\n';
+    return -1;
+  }
+  return 0;
+}
+
+int handleDecompress(Command const & cmd) {
+  try {
+    CompressedFile const file(cmd.input);
+    decompressToPPM(file, cmd.output);
+  } catch (std::exception const & e) {
+    std::cerr << "Error: " << e.what() << '\n';
+    return -1;
+  }
+  return 0;
+}
+
+int handleInfo(Command const & cmd) {
+  try {
+    auto const [magicNumber, width, height, maxColorValue] = loadMetadata(cmd.input);
+    // Built first and written at once so concurrent batch jobs do not interleave their lines
+    std::ostringstream info;
+    info << "Magic Number: " << magicNumber << '\n';
+    info << "Max Color Value: " << maxColorValue << '\n';
+    info << "Image height: " << height << '\n';
+    info << "Image width: " << width << '\n';
+    std::cout << info.str();
+  } catch (std::exception const & e) {
+    std::cerr << "Error: " << e.what() << '\n';
+    return -1;
+  }
+  return 0;
+}
+
+int handleBatch(Command const & cmd) {
+  try {
+    std::vector<BatchJob> const jobs = readManifest(cmd.input);
+    ThreadPool & pool                      = sharedThreadPool();
+    auto const start                       = std::chrono::steady_clock::now();
+    std::vector<BatchResult> const results = runBatch(jobs, pool);
+    std::chrono::duration<double, std::milli> const total = std::chrono::steady_clock::now() - start;
+
+    size_t succeeded = 0;
+    std::ostringstream report;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+      bool const success = results[i].status == 0;
+      if (success) { ++succeeded; }
+      report << "Job " << jobs[i].line << ": " << (success ? "ok" : "failed") << " in "
+             << results[i].milliseconds << " ms:";
+      for (size_t arg = 1; arg < jobs[i].arguments.size(); ++arg) {
+        report << ' ' << jobs[i].arguments[arg];
+      }
+      report << '\n';
+    }
+    report << "Batch: " << succeeded << '/' << jobs.size() << " jobs succeeded in " << total.count()
+           << " ms on " << pool.size() << " threads\n";
+    std::cout << report.str();
+    return succeeded == jobs.size() ? 0 : -1;
+  } catch (std::exception const & e) {
+    std::cerr << "Error: " << e.what() << '\n';
+    return -1;
+  }
+}
+
+int operate(std::vector<std::string> const& arguments, std::optional<Command> const& cmd) {
+  // Check if cmd has a value
+  if (!cmd.has_value()) {
+    std::cerr << "Error: Command is not provided.\n";
+    return -1;
+  }
+
+  // Safe access to cmd
+  switch (cmd->operation) {
+    case 0:
+    {
+      // Info
+      return handleInfo(*cmd);
+    }
+    case 1:
+    {
+      // Maxlevel
+      return handleMaxLevel(*cmd);
+    }
+    case 2:
+    {
+      // Resize
+      return handleResize(*cmd);
+    }
+    case 3:
+    {
+      // Cutfreq
+      return handleCutfreq(*cmd);
+    }
+    case 4:
+    {
+      // Compress
+      return handleCompress(*cmd);
+    }
+    case decompressOperation:
+    {
+      // Decompress
+      return handleDecompress(*cmd);
+    }
+    case pyramidOperation:
+    {
+      // Pyramid of resized levels
+      return handlePyramid(*cmd);
+    }
+    case batchOperation:
+    {
+      // Batch manifest
+      return handleBatch(*cmd);
+    }
+    default:
+    {
+      std::cerr << "Error: Invalid option: " << arguments[3] << '\n';
+      return -1;
+    }
+  }
+}
+
+int runCommand(std::vector<std::string> arguments) {
+  if (!takeThreadsOption(arguments)) { return -1; }
+  if (arguments.size() < 3) {
+    std::cout << "Error: Invalid number of arguments: " << arguments.size() << '\n';
+    return 1;
+  }
+  auto const cmd = sanitizeArgs(arguments);
+  if (!cmd) { return -1; }
+  if (cmd->operation == -1) { return -1; }
+  if (checkProperArgumentNumber(cmd->operation, arguments.size(), cmd.value()) == 0) { return -1; }
+  try {
+    return operate(arguments, cmd);
+  } catch (std::exception const & e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    return -1;
+  }
+}
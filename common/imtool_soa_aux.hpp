@@ -1,30 +1,54 @@
-//
-// Created by Alberto on 13/11/2024.
-//
-
-#ifndef IMTOOL_SOA_AUX_H
-#define IMTOOL_SOA_AUX_H
-
-#include <optional>
-#include <string>
-#include <vector>
-
-
-struct Command {
-    std::string input;
-    std::string output;
-    int operation;
-    std::string op1;
-    std::string op2;
-};
-
-auto sanitizeArgs(std::vector<std::string> const & args) -> std::optional<Command>;
-int checkProperArgumentNumber(int operation, size_t argv_size, const Command& cmd);
-void handleMaxLevel(Command const & cmd);
-void handleResize(Command const & cmd);
-int handleCutfreq(Command const & cmd);
-void handleInfo(Command const & cmd);
-
-int operate(std::vector<std::string> const& arguments, std::optional<Command> const& cmd);
-
-#endif  // IMTOOL_SOA_AUX_H
+//
+// Created by Alberto on 13/11/2024.
+//
+
+#ifndef IMTOOL_SOA_AUX_H
+#define IMTOOL_SOA_AUX_H
+
+#include <optional>
+#include <string>
+#include <vector>
+
+
+// Operation code of "<manifest> batch"
+constexpr int batchOperation = 5;
+// Operation code of "<input> <output> decompress"
+constexpr int decompressOperation = 6;
+// Operation code of "<input> <output> pyramid <levels>"
+constexpr int pyramidOperation = 7;
+
+struct Command {
+    std::string input;
+    std::string output;
+    int operation;
+    std::string op1;
+    std::string op2;
+    // Optional resize filter (see common/resample.hpp)
+    std::string op3;
+};
+
+// Remove "--threads N" (anywhere after the program name) from args and size the shared thread
+// pool to N. Returns false after reporting a missing or invalid N.
+bool takeThreadsOption(std::vector<std::string> & args);
+auto sanitizeArgs(std::vector<std::string> const & args) -> std::optional<Command>;
+int checkProperArgumentNumber(int operation, size_t argv_size, const Command& cmd);
+// Every handler returns 0 on success and -1 after reporting an error
+int handleMaxLevel(Command const & cmd);
+int handleResize(Command const & cmd);
+int handleCutfreq(Command const & cmd);
+int handleCompress(Command const & cmd);
+int handleDecompress(Command const & cmd);
+// Resize the input to every level of cmd.op1, a comma-separated list of WxH or W (height kept
+// in proportion), largest first. The input is loaded once and each level is reduced from the
+// previous one with the box filter; level WxH is written to cmd.output with "-WxH" before the
+// extension.
+int handlePyramid(Command const & cmd);
+int handleInfo(Command const & cmd);
+int handleBatch(Command const & cmd);
+
+int operate(std::vector<std::string> const& arguments, std::optional<Command> const& cmd);
+
+// Parse, validate and run one command given as argv (program name first)
+int runCommand(std::vector<std::string> arguments);
+
+#endif  // IMTOOL_SOA_AUX_H
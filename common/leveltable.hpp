@@ -0,0 +1,32 @@
+#ifndef LEVELTABLE_HPP
+#define LEVELTABLE_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <sys/types.h>
+#include <vector>
+
+// maxlevel result for every value an In sample can hold (256 or 65536 entries), so rescaling a
+// channel is a gather instead of per-sample float math. Each entry is computed exactly as the
+// per-sample code did, floor(float(value) * float(newMax) / float(currentMax)), including values
+// above currentMax.
+template <typename In, typename Out>
+std::vector<Out> maxLevelTable(uint const currentMax, uint const newMax) {
+  auto const scale = static_cast<float>(newMax) / static_cast<float>(currentMax);
+  std::vector<Out> table(size_t{std::numeric_limits<In>::max()} + 1);
+  for (size_t value = 0; value < table.size(); ++value) {
+    table[value] = static_cast<Out>(std::floor(static_cast<float>(value) * scale));
+  }
+  return table;
+}
+
+// out[i] = table[in[i]]; in and out may be the same channel
+template <typename In, typename Out>
+void applyLevelTable(std::span<In const> const input, std::span<Out> const output,
+                     std::vector<Out> const & table) {
+  for (size_t i = 0; i < input.size(); ++i) { output[i] = table[input[i]]; }
+}
+
+#endif //LEVELTABLE_HPP
@@ -0,0 +1,251 @@
+#include "palette.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+  constexpr uint initialShift     = 54; // 1024 slots
+  constexpr uint64_t hashMultiple = 0x9E3779B97F4A7C15ULL;
+  constexpr uint max8bit          = 255;
+  constexpr uint byteBits         = 8;
+  constexpr uint byteMask         = 0xFF;
+  // Indices packed per write; a multiple of 8 keeps every chunk byte-aligned for any width
+  constexpr size_t packChunk = size_t{1} << 20U;
+  constexpr size_t maxHeaderBytes = 128;
+  constexpr uint max16bit         = 65535;
+  constexpr char const * magic    = "C6";
+
+  size_t slotOf(uint64_t const key, uint const shift) {
+    return static_cast<size_t>((key * hashMultiple) >> shift);
+  }
+
+  void writeBytes(std::ofstream & file, std::span<uint8_t const> const bytes) {
+    file.write(reinterpret_cast<char const *>(bytes.data()), // NOLINT(*-pro-type-reinterpret-cast)
+               static_cast<std::streamsize>(bytes.size()));
+  }
+
+  std::vector<uint8_t> colorTable(std::vector<uint64_t> const & colors, uint const maxColorValue) {
+    size_t const sampleBytes = maxColorValue > max8bit ? 2 : 1;
+    std::vector<uint8_t> table;
+    table.reserve(colors.size() * 3 * sampleBytes);
+    for (uint64_t const key : colors) {
+      for (uint16_t const sample : {keyRed(key), keyGreen(key), keyBlue(key)}) {
+        table.push_back(static_cast<uint8_t>(sample & byteMask));
+        if (sampleBytes == 2) { table.push_back(static_cast<uint8_t>(sample >> byteBits)); }
+      }
+    }
+    return table;
+  }
+
+  // Narrow widths: every byte holds 8 / Bits indices, lowest bits first. The per-byte loop has a
+  // constant trip count so the compiler unrolls and vectorizes it.
+  template <uint Bits>
+  void unpackNarrow(std::span<uint8_t const> const bytes, std::span<uint32_t> const out) {
+    constexpr uint perByte = byteBits / Bits;
+    constexpr uint mask    = (1U << Bits) - 1;
+    size_t const full      = out.size() / perByte;
+    for (size_t byte = 0; byte < full; ++byte) {
+      for (uint k = 0; k < perByte; ++k) {
+        out[(byte * perByte) + k] = (uint32_t{bytes[byte]} >> (k * Bits)) & mask;
+      }
+    }
+    for (size_t i = full * perByte; i < out.size(); ++i) {
+      out[i] = (uint32_t{bytes[i / perByte]} >> ((i % perByte) * Bits)) & mask;
+    }
+  }
+
+  template <typename Index>
+  void unpackWide(std::span<uint8_t const> const bytes, std::span<uint32_t> const out) {
+    for (size_t i = 0; i < out.size(); ++i) {
+      uint32_t value = 0;
+      for (size_t byte = 0; byte < sizeof(Index); ++byte) {
+        value |= uint32_t{bytes[(i * sizeof(Index)) + byte]} << (byte * byteBits);
+      }
+      out[i] = value;
+    }
+  }
+} // namespace
+
+uint indexBits(size_t const colors) {
+  uint bits = 1;
+  while (bits < 32 && (size_t{1} << bits) < colors) { bits *= 2; }
+  return bits;
+}
+
+PaletteBuilder::PaletteBuilder()
+  : slots(size_t{1} << (64 - initialShift)), values(slots.size()), shift(initialShift) { }
+
+uint32_t PaletteBuilder::indexOf(uint64_t const key) {
+  size_t const mask = slots.size() - 1;
+  for (size_t slot = slotOf(key, shift);; slot = (slot + 1) & mask) {
+    if (slots[slot] == key + 1) { return values[slot]; }
+    if (slots[slot] == 0) {
+      auto const index = static_cast<uint32_t>(colors.size());
+      slots[slot]      = key + 1;
+      values[slot]     = index;
+      colors.push_back(key);
+      // Keep the load factor at or below one half
+      if (colors.size() * 2 > slots.size()) { grow(); }
+      return index;
+    }
+  }
+}
+
+void PaletteBuilder::grow() {
+  size_t const capacity                 = slots.size() * 2;
+  std::vector<uint64_t> const oldSlots  = std::exchange(slots, std::vector<uint64_t>(capacity));
+  std::vector<uint32_t> const oldValues = std::exchange(values, std::vector<uint32_t>(capacity));
+  --shift;
+  size_t const mask = slots.size() - 1;
+  for (size_t i = 0; i < oldSlots.size(); ++i) {
+    if (oldSlots[i] == 0) { continue; }
+    size_t slot = slotOf(oldSlots[i] - 1, shift);
+    while (slots[slot] != 0) { slot = (slot + 1) & mask; }
+    slots[slot]  = oldSlots[i];
+    values[slot] = oldValues[i];
+  }
+}
+
+size_t packedBytes(size_t const count, uint const bits) {
+  return ((count * bits) + byteBits - 1) / byteBits;
+}
+
+void packIndices(std::span<uint32_t const> const indices, uint const bits,
+                 std::span<uint8_t> const out) {
+  if (bits < byteBits) {
+    std::fill_n(out.begin(), packedBytes(indices.size(), bits), uint8_t{0});
+    uint const perByte = byteBits / bits;
+    for (size_t i = 0; i < indices.size(); ++i) {
+      out[i / perByte] |= static_cast<uint8_t>(indices[i] << ((i % perByte) * bits));
+    }
+    return;
+  }
+  size_t const bytes = bits / byteBits;
+  for (size_t i = 0; i < indices.size(); ++i) {
+    for (size_t byte = 0; byte < bytes; ++byte) {
+      out[(i * bytes) + byte] = static_cast<uint8_t>(indices[i] >> (byte * byteBits));
+    }
+  }
+}
+
+void saveCompressed(std::string const & filename, CompressedFormat const & format,
+                    Palette const & palette) {
+  std::ofstream file(filename, std::ios::binary);
+  if (!file.is_open()) { throw std::runtime_error("Failed to open the file: " + filename); }
+  file << "C6 " << format.width << ' ' << format.height << ' ' << format.maxColorValue << ' '
+       << palette.colors.size() << '\n';
+  writeBytes(file, colorTable(palette.colors, format.maxColorValue));
+
+  uint const bits = indexBits(palette.colors.size());
+  std::vector<uint8_t> packed(packedBytes(packChunk, bits));
+  std::span<uint32_t const> const indices(palette.indices);
+  for (size_t first = 0; first < indices.size(); first += packChunk) {
+    auto const chunk = indices.subspan(first, std::min(packChunk, indices.size() - first));
+    packIndices(chunk, bits, packed);
+    writeBytes(file, std::span<uint8_t const>(packed).first(packedBytes(chunk.size(), bits)));
+  }
+  if (!file) { throw std::runtime_error("Failed to write the file: " + filename); }
+}
+
+bool isCompressedFile(std::string const & filepath) {
+  std::ifstream file(filepath, std::ios::binary);
+  std::array<char, 2> start{};
+  file.read(start.data(), start.size());
+  return file && std::string(start.data(), start.size()) == magic;
+}
+
+CompressedFile::CompressedFile(std::string const & filepath) : filepath(filepath), file(filepath) {
+  std::span<uint8_t const> const bytes = file.bytes();
+  auto const headerBytes               = bytes.first(std::min(bytes.size(), maxHeaderBytes));
+  std::istringstream header(std::string(headerBytes.begin(), headerBytes.end()));
+  std::string magicNumber;
+  size_t colorCount = 0;
+  header >> magicNumber >> geometry.width >> geometry.height >> geometry.maxColorValue >> colorCount;
+  size_t const pixels = geometry.width * geometry.height;
+  // A single whitespace byte separates the header from the color table
+  char const separator = static_cast<char>(header.get());
+  if (!header || std::isspace(static_cast<unsigned char>(separator)) == 0 || magicNumber != magic || pixels == 0 || geometry.maxColorValue == 0 ||
+      geometry.maxColorValue > max16bit || colorCount == 0 || colorCount > pixels) {
+    throw std::runtime_error("Invalid compressed image header: " + filepath);
+  }
+  auto const tableStart    = static_cast<size_t>(header.tellg());
+  size_t const sampleBytes = geometry.maxColorValue > max8bit ? 2 : 1;
+  size_t const tableBytes  = colorCount * 3 * sampleBytes;
+  bits                     = indexBits(colorCount);
+  size_t const indexBytes  = packedBytes(pixels, bits);
+  if (bytes.size() < tableStart + tableBytes + indexBytes) {
+    throw std::runtime_error("Failed to read pixel data from: " + filepath);
+  }
+
+  table.reserve(colorCount);
+  for (size_t color = 0; color < colorCount; ++color) {
+    std::array<uint, 3> samples{};
+    for (size_t channel = 0; channel < 3; ++channel) {
+      size_t const offset = tableStart + (((color * 3) + channel) * sampleBytes);
+      samples[channel]    = bytes[offset];
+      if (sampleBytes == 2) { samples[channel] |= uint{bytes[offset + 1]} << byteBits; }
+    }
+    table.push_back(colorKey(samples[0], samples[1], samples[2]));
+  }
+  packed = bytes.subspan(tableStart + tableBytes, indexBytes);
+}
+
+void CompressedFile::unpack(size_t const first, std::span<uint32_t> const out) const {
+  auto const from = [this, first](size_t const bytesPerIndex) {
+    return packed.subspan(first * bytesPerIndex);
+  };
+  switch (bits) {
+    case 1:
+      unpackNarrow<1>(packed.subspan(first / byteBits), out);
+      break;
+    case 2:
+      unpackNarrow<2>(packed.subspan(first / 4), out);
+      break;
+    case 4:
+      unpackNarrow<4>(packed.subspan(first / 2), out);
+      break;
+    case byteBits:
+      unpackWide<uint8_t>(from(1), out);
+      break;
+    case 2 * byteBits:
+      unpackWide<uint16_t>(from(2), out);
+      break;
+    default:
+      unpackWide<uint32_t>(from(4), out);
+      break;
+  }
+  if (*std::ranges::max_element(out) >= table.size()) {
+    throw std::runtime_error("Color index out of range in: " + filepath);
+  }
+}
+
+void decompressToPPM(CompressedFile const & file, std::string const & output) {
+  CompressedFormat const & format = file.format();
+  size_t const sampleBytes        = format.maxColorValue > max8bit ? 2 : 1;
+  size_t const pixelBytes         = 3 * sampleBytes;
+  // Every color already encoded as its interleaved big-endian PPM bytes
+  std::vector<uint8_t> entries;
+  entries.reserve(file.colors().size() * pixelBytes);
+  for (uint64_t const key : file.colors()) {
+    for (uint16_t const sample : {keyRed(key), keyGreen(key), keyBlue(key)}) {
+      if (sampleBytes == 2) { entries.push_back(static_cast<uint8_t>(sample >> byteBits)); }
+      entries.push_back(static_cast<uint8_t>(sample & byteMask));
+    }
+  }
+
+  PPMWriter writer(output);
+  writer.writeHeader(format.width, format.height, format.maxColorValue);
+  std::vector<uint8_t> block;
+  file.forEachIndexChunk([&](size_t, std::span<uint32_t const> const indices) {
+    block.resize(indices.size() * pixelBytes);
+    for (size_t i = 0; i < indices.size(); ++i) {
+      std::memcpy(&block[i * pixelBytes], &entries[indices[i] * pixelBytes], pixelBytes);
+    }
+    writer.writePayload(block);
+  });
+}
@@ -0,0 +1,159 @@
+#ifndef PALETTE_HPP
+#define PALETTE_HPP
+
+#include "binaryio.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <sys/types.h>
+#include <utility>
+#include <vector>
+
+// Compressed image format ("C6"):
+//   C6 <width> <height> <maxval> <ncolors>\n
+//   color table: ncolors RGB entries, 1 byte per sample up to maxval 255, else 2 (little-endian)
+//   indices: one per pixel in row-major order, packed at indexBits(ncolors) bits. Narrow indices
+//            fill each byte from its least significant bit; 8/16/32-bit ones are little-endian.
+
+// RGB sample triple packed into one key (16 bits per sample), used as the palette hash key
+constexpr uint64_t colorKey(uint const red, uint const green, uint const blue) {
+  constexpr uint sampleBits = 16;
+  return (uint64_t{red} << (2 * sampleBits)) | (uint64_t{green} << sampleBits) | uint64_t{blue};
+}
+
+constexpr uint16_t keyRed(uint64_t const key) { return static_cast<uint16_t>(key >> 32U); }
+
+constexpr uint16_t keyGreen(uint64_t const key) { return static_cast<uint16_t>(key >> 16U); }
+
+constexpr uint16_t keyBlue(uint64_t const key) { return static_cast<uint16_t>(key); }
+
+// Smallest of 1, 2, 4, 8, 16 or 32 bits that can address colors entries
+uint indexBits(size_t colors);
+
+// Distinct colors in order of first appearance plus the index of every pixel into them
+struct Palette {
+    std::vector<uint64_t> colors;
+    std::vector<uint32_t> indices;
+};
+
+// Open-addressing hash from color key to palette index. New colors are appended to the palette.
+class PaletteBuilder {
+  public:
+    PaletteBuilder();
+
+    uint32_t indexOf(uint64_t key);
+
+    [[nodiscard]] std::vector<uint64_t> takeColors() { return std::move(colors); }
+
+  private:
+    std::vector<uint64_t> slots;   // key + 1, 0 marks an empty slot
+    std::vector<uint32_t> values;
+    std::vector<uint64_t> colors;
+    uint shift = 0;
+    void grow();
+};
+
+// Build the palette of pixelCount pixels; colorAt(i) returns the colorKey of pixel i. Runs of
+// equal colors (common in low-color images) skip the hash lookup.
+template <typename ColorAt>
+Palette buildPalette(size_t const pixelCount, ColorAt colorAt) {
+  PaletteBuilder builder;
+  Palette palette;
+  palette.indices.resize(pixelCount);
+  uint64_t lastKey   = ~uint64_t{0};
+  uint32_t lastIndex = 0;
+  for (size_t i = 0; i < pixelCount; ++i) {
+    uint64_t const key = colorAt(i);
+    if (key != lastKey) {
+      lastIndex = builder.indexOf(key);
+      lastKey   = key;
+    }
+    palette.indices[i] = lastIndex;
+  }
+  palette.colors = builder.takeColors();
+  return palette;
+}
+
+// Pack indices at bits per index into out, which must hold packedBytes(indices.size(), bits)
+size_t packedBytes(size_t count, uint bits);
+void packIndices(std::span<uint32_t const> indices, uint bits, std::span<uint8_t> out);
+
+struct CompressedFormat {
+    size_t width       = 0;
+    size_t height      = 0;
+    uint maxColorValue = 0;
+};
+
+void saveCompressed(std::string const & filename, CompressedFormat const & format,
+                    Palette const & palette);
+
+// True when the file starts with the compressed format's magic number
+bool isCompressedFile(std::string const & filepath);
+
+// A compressed image opened once: header and color table are parsed up front, indices are
+// unpacked on demand a chunk at a time so no full-size index array is ever built
+class CompressedFile {
+  public:
+    explicit CompressedFile(std::string const & filepath);
+
+    [[nodiscard]] CompressedFormat const & format() const { return geometry; }
+
+    [[nodiscard]] std::vector<uint64_t> const & colors() const { return table; }
+
+    // visit(first, indices) for consecutive chunks of at most indexChunk pixel indices
+    template <typename Visit>
+    void forEachIndexChunk(Visit visit) const {
+      std::array<uint32_t, indexChunk> indices{};
+      size_t const total = geometry.width * geometry.height;
+      for (size_t first = 0; first < total; first += indexChunk) {
+        std::span<uint32_t> const chunk =
+          std::span(indices).first(std::min(indexChunk, total - first));
+        unpack(first, chunk);
+        visit(first, std::span<uint32_t const>(chunk));
+      }
+    }
+
+  private:
+    // A multiple of 8 so chunks of sub-byte indices start on a byte boundary
+    static constexpr size_t indexChunk = 4096;
+
+    std::string filepath;
+    MappedFile file;
+    CompressedFormat geometry;
+    std::vector<uint64_t> table;
+    std::span<uint8_t const> packed;
+    uint bits = 1;
+
+    // Unpack indices [first, first + out.size()); throws on an index outside the color table
+    void unpack(size_t first, std::span<uint32_t> out) const;
+};
+
+// Decode every pixel into three channels (8 or 16-bit samples) through per-channel tables
+template <typename Sample>
+void decodeChannels(CompressedFile const & file, std::span<Sample> const red,
+                    std::span<Sample> const green, std::span<Sample> const blue) {
+  std::vector<Sample> redTable;
+  std::vector<Sample> greenTable;
+  std::vector<Sample> blueTable;
+  for (uint64_t const key : file.colors()) {
+    redTable.push_back(static_cast<Sample>(keyRed(key)));
+    greenTable.push_back(static_cast<Sample>(keyGreen(key)));
+    blueTable.push_back(static_cast<Sample>(keyBlue(key)));
+  }
+  file.forEachIndexChunk([&](size_t const first, std::span<uint32_t const> const indices) {
+    for (size_t i = 0; i < indices.size(); ++i) {
+      red[first + i]   = redTable[indices[i]];
+      green[first + i] = greenTable[indices[i]];
+      blue[first + i]  = blueTable[indices[i]];
+    }
+  });
+}
+
+// Write a compressed image back as a binary PPM without building any intermediate image
+void decompressToPPM(CompressedFile const & file, std::string const & output);
+
+#endif //PALETTE_HPP
@@ -0,0 +1,56 @@
+#include "ppminfo.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+  constexpr char listPrefix = '@';
+
+  std::vector<std::string> listDirectory(std::filesystem::path const & directory) {
+    std::vector<std::string> paths;
+    for (auto const & entry : std::filesystem::directory_iterator(directory)) {
+      if (entry.is_regular_file() && entry.path().extension() == ".ppm") {
+        paths.push_back(entry.path().string());
+      }
+    }
+    std::ranges::sort(paths);
+    return paths;
+  }
+
+  std::vector<std::string> listFile(std::string const & listPath) {
+    std::ifstream list(listPath);
+    if (!list.is_open()) { throw std::runtime_error("Failed to open the file: " + listPath); }
+    std::vector<std::string> paths;
+    for (std::string line; std::getline(list, line);) {
+      if (!line.empty() && line.back() == '\r') { line.pop_back(); }
+      if (!line.empty()) { paths.push_back(line); }
+    }
+    return paths;
+  }
+} // namespace
+
+bool isInfoBatchSource(std::string const & source) {
+  return (!source.empty() && source.front() == listPrefix) ||
+         std::filesystem::is_directory(source);
+}
+
+std::vector<std::string> listInfoInputs(std::string const & source) {
+  if (!source.empty() && source.front() == listPrefix) { return listFile(source.substr(1)); }
+  return listDirectory(source);
+}
+
+std::vector<InfoEntry> readInfoBatch(std::vector<std::string> const & paths, ThreadPool & pool) {
+  std::vector<InfoEntry> entries(paths.size());
+  // Each image is independent and writes only its own slot
+  pool.parallelFor(paths.size(), [&](size_t const index) {
+    InfoEntry & entry = entries[index];
+    entry.path        = paths[index];
+    try {
+      entry.header = readPPMHeader(entry.path);
+    } catch (std::exception const & e) { entry.error = e.what(); }
+  });
+  return entries;
+}
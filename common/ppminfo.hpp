@@ -0,0 +1,26 @@
+#ifndef PPMINFO_HPP
+#define PPMINFO_HPP
+
+#include "binaryio.hpp"
+#include "threadpool.hpp"
+
+#include <string>
+#include <vector>
+
+// Header of one image in a batch info run; error is set instead when it could not be read
+struct InfoEntry {
+    std::string path;
+    PPMHeader header;
+    std::string error;
+};
+
+// A batch source is a directory or '@' followed by a file holding one path per line
+bool isInfoBatchSource(std::string const & source);
+
+// Every .ppm file of a directory (sorted by name) or every non-empty line of a list file
+std::vector<std::string> listInfoInputs(std::string const & source);
+
+// Read only the headers of paths on the pool. Results keep the order of paths.
+std::vector<InfoEntry> readInfoBatch(std::vector<std::string> const & paths, ThreadPool & pool);
+
+#endif //PPMINFO_HPP
@@ -0,0 +1,144 @@
+#include "ppmstream.hpp"
+
+#include "binaryio.hpp"
+#include "simdkernels.hpp"
+#include "threadpool.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+  constexpr uint max8bit      = 255;
+  constexpr size_t channels   = 3;
+  constexpr uint8_t byteShift = 8;
+  constexpr uint lowByte      = 0xFF;
+
+  size_t sampleBytes(uint const maxColorValue) { return maxColorValue > max8bit ? 2 : 1; }
+
+  // Opens input positioned at the first payload byte and returns its header
+  PPMHeader openPayload(std::string const & input, std::ifstream & file) {
+    file.open(input, std::ios::binary);
+    if (!file.is_open()) { throw std::runtime_error("Failed to open the file: " + input); }
+    PPMHeader const header = readPPMHeader(file);
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(header.payloadOffset));
+    return header;
+  }
+
+  // Samples mapped per task: the 16-bit scratch buffers of a chunk stay in L2
+  constexpr size_t chunkSamples = size_t{1} << 16U;
+
+  void decodeBE(std::span<uint8_t const> const bytes, std::span<uint16_t> const samples) {
+    for (size_t i = 0; i < samples.size(); ++i) {
+      samples[i] = static_cast<uint16_t>((bytes[2 * i] << byteShift) | bytes[(2 * i) + 1]);
+    }
+  }
+
+  void encodeBE(std::span<uint16_t const> const samples, std::span<uint8_t> const bytes) {
+    for (size_t i = 0; i < samples.size(); ++i) {
+      bytes[2 * i]       = static_cast<uint8_t>(samples[i] >> byteShift);
+      bytes[(2 * i) + 1] = static_cast<uint8_t>(samples[i] & lowByte);
+    }
+  }
+
+  struct SampleFormat {
+      size_t inWidth  = 1;
+      size_t outWidth = 1;
+      LevelScale scale;
+  };
+
+  // Rescale one chunk of interleaved payload bytes: 8-bit samples are read and written in place,
+  // 16-bit ones go through big-endian decode / encode scratch buffers
+  void mapChunk(std::span<uint8_t const> const input, std::span<uint8_t> const output,
+                SampleFormat const & format) {
+    thread_local std::vector<uint16_t> wideIn;
+    thread_local std::vector<uint16_t> wideOut;
+    size_t const samples = input.size() / format.inWidth;
+    if (format.inWidth == 2) {
+      wideIn.resize(std::max(wideIn.size(), samples));
+      decodeBE(input, std::span(wideIn).first(samples));
+    }
+    if (format.outWidth == 2) { wideOut.resize(std::max(wideOut.size(), samples)); }
+    auto const decoded = std::span<uint16_t const>(wideIn).first(format.inWidth == 2 ? samples : 0);
+    auto const encoded = std::span(wideOut).first(format.outWidth == 2 ? samples : 0);
+    if (format.inWidth == 1 && format.outWidth == 1) {
+      scaleSamples(input, output, format.scale);
+    } else if (format.inWidth == 1) {
+      scaleSamples(input, encoded, format.scale);
+    } else if (format.outWidth == 1) {
+      scaleSamples(decoded, output, format.scale);
+    } else {
+      scaleSamples(decoded, encoded, format.scale);
+    }
+    if (format.outWidth == 2) { encodeBE(encoded, output); }
+  }
+
+  // Rescale a block of whole samples, split into chunks over the shared pool. Chunks are
+  // independent, so the output does not depend on the thread count.
+  void mapBlock(std::span<uint8_t const> const input, std::span<uint8_t> const output,
+                SampleFormat const & format) {
+    size_t const samples = input.size() / format.inWidth;
+    size_t const chunks  = (samples + chunkSamples - 1) / chunkSamples;
+    sharedThreadPool().parallelFor(chunks, [&](size_t const chunk) {
+      size_t const first = chunk * chunkSamples;
+      size_t const count = std::min(chunkSamples, samples - first);
+      mapChunk(input.subspan(first * format.inWidth, count * format.inWidth),
+               output.subspan(first * format.outWidth, count * format.outWidth), format);
+    });
+  }
+} // namespace
+
+void streamMaxLevel(StreamJob const & job, uint const newMax) {
+  std::ifstream input;
+  PPMHeader const format = openPayload(job.input, input);
+  PPMWriter writer(job.output);
+  writer.writeHeader(format.width, format.height, newMax);
+
+  SampleFormat const samples = {
+    .inWidth  = format.sampleBytes(),
+    .outWidth = sampleBytes(newMax),
+    .scale    = {.currentMax = format.maxColorValue, .newMax = newMax}
+  };
+  size_t const rowSamples   = format.width * channels;
+  size_t const rowBytes     = rowSamples * std::max(samples.inWidth, samples.outWidth);
+  size_t const rowsPerBlock = std::max<size_t>(1, job.blockBytes / rowBytes);
+  std::vector<uint8_t> inBlock(rowsPerBlock * rowSamples * samples.inWidth);
+  std::vector<uint8_t> outBlock(rowsPerBlock * rowSamples * samples.outWidth);
+
+  for (size_t row = 0; row < format.height; row += rowsPerBlock) {
+    size_t const count = std::min(rowsPerBlock, format.height - row) * rowSamples;
+    input.read(reinterpret_cast<char *>(inBlock.data()), // NOLINT(*-pro-type-reinterpret-cast)
+               static_cast<std::streamsize>(count * samples.inWidth));
+    if (!input) { throw std::runtime_error("Failed to read pixel data from: " + job.input); }
+    auto const out = std::span(outBlock).first(count * samples.outWidth);
+    mapBlock(std::span<uint8_t const>(inBlock).first(count * samples.inWidth), out, samples);
+    writer.writePayload(out);
+  }
+}
+
+void fusedMaxLevel(PPMFile const & input, std::string const & output, uint const newMax) {
+  PPMHeader const & format = input.header();
+  PPMWriter writer(output);
+  writer.writeHeader(format.width, format.height, newMax);
+
+  SampleFormat const samples = {
+    .inWidth  = format.sampleBytes(),
+    .outWidth = sampleBytes(newMax),
+    .scale    = {.currentMax = format.maxColorValue, .newMax = newMax}
+  };
+  std::span<uint8_t const> const payload = input.payload();
+  size_t const total                     = payload.size() / samples.inWidth;
+  size_t const blockSamples              = std::max<size_t>(
+    1, defaultStreamBlockBytes / std::max(samples.inWidth, samples.outWidth));
+  std::vector<uint8_t> outBlock(std::min(total, blockSamples) * samples.outWidth);
+  for (size_t first = 0; first < total; first += blockSamples) {
+    size_t const count = std::min(blockSamples, total - first);
+    auto const out     = std::span(outBlock).first(count * samples.outWidth);
+    mapBlock(payload.subspan(first * samples.inWidth, count * samples.inWidth), out, samples);
+    writer.writePayload(out);
+  }
+}
@@ -0,0 +1,32 @@
+#ifndef PPMSTREAM_HPP
+#define PPMSTREAM_HPP
+
+#include "binaryio.hpp"
+
+#include <cstddef>
+#include <string>
+#include <sys/types.h>
+
+// Rows are processed in blocks of at most this many bytes (input or output, whichever is larger)
+constexpr size_t defaultStreamBlockBytes = size_t{8} << 20U;
+
+// Payloads at least this large are processed in blocks instead of being loaded whole
+constexpr size_t streamingThresholdBytes = size_t{1} << 30U;
+
+struct StreamJob {
+    std::string input;
+    std::string output;
+    size_t blockBytes = defaultStreamBlockBytes;
+};
+
+// Rescale every sample to newMax reading and writing one block of rows at a time, so memory use is
+// bounded by job.blockBytes. The geometry comes from the input's own header. Handles 8<->16 bit
+// depth changes; output matches ImageSOA maxLevel.
+void streamMaxLevel(StreamJob const & job, uint newMax);
+
+// maxlevel fused into a single pass over an opened PPM: interleaved samples are read from the
+// mapped payload, rescaled and written interleaved again, one block at a time, without ever
+// building channel vectors. Handles 8<->16 bit depth changes; output matches ImageSOA maxLevel.
+void fusedMaxLevel(PPMFile const & input, std::string const & output, uint newMax);
+
+#endif //PPMSTREAM_HPP
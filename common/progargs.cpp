@@ -1,4 +1,5 @@
 #include "progargs.hpp"
+#include "resample.hpp"
 #include <iostream>
 #include <stdexcept>
 #include <vector>
@@ -17,6 +18,7 @@ ProgramArgs processArgs(const std::vector<std::string>& arguments) {
     validateOperation(args.operation, static_cast<int>(arguments.size()));
     constexpr int cinco = 5;
     constexpr int seis = 6;
+    constexpr int siete = 7;
     // Validar parámetros adicionales según la operación
     if (args.operation == "maxlevel") {
         if (arguments.size() != cinco) {
@@ -25,11 +27,13 @@ ProgramArgs processArgs(const std::vector<std::string>& arguments) {
         args.extraParams.push_back(arguments[4]);
         validateMaxlevel(args.extraParams);
     } else if (args.operation == "resize") {
-        if (arguments.size() != seis) {
+        if (arguments.size() != seis && arguments.size() != siete) {
             throw std::runtime_error("Error: Invalid number of extra arguments for resize: " + std::to_string(arguments.size() - 4));
         }
         args.extraParams.push_back(arguments[4]);
         args.extraParams.push_back(arguments[cinco]);
+        // Filtro opcional (ver common/resample.hpp)
+        if (arguments.size() == siete) { args.extraParams.push_back(arguments[seis]); }
         validateResize(args.extraParams);
     } else if (args.operation == "cutfreq") {
         if (arguments.size() != cinco) {
@@ -45,19 +49,20 @@ ProgramArgs processArgs(const std::vector<std::string>& arguments) {
 void validateOperation(const std::string& operation, const int argc) {
     constexpr int cinco = 5;
     constexpr int seis = 6;
+    constexpr int siete = 7;
     if (operation != "info" && operation != "maxlevel" &&
         operation != "resize" && operation != "cutfreq" &&
-        operation != "compress") {
+        operation != "compress" && operation != "decompress") {
         throw std::runtime_error("Error: Invalid option: " + operation);
     }
 
-    if ((operation == "info" || operation == "compress") && argc != 4) {
+    if ((operation == "info" || operation == "compress" || operation == "decompress") && argc != 4) {
         throw std::runtime_error("Error: Invalid extra arguments for " + operation + ": " + std::to_string(argc - 4));
     }
     if (operation == "maxlevel" && argc != cinco) {
         throw std::runtime_error("Error: Invalid number of extra arguments for maxlevel: " + std::to_string(argc - 4));
     }
-    if (operation == "resize" && argc != seis) {
+    if (operation == "resize" && argc != seis && argc != siete) {
         throw std::runtime_error("Error: Invalid number of extra arguments for resize: " + std::to_string(argc - 4));
     }
     if (operation == "cutfreq" && argc != cinco) {
@@ -90,6 +95,9 @@ void validateResize(const std::vector<std::string>& args) {
     } catch (const std::invalid_argument&) {
         throw std::runtime_error("Error: Invalid resize height or width: " + args[0] + " or " + args[1]);
     }
+    if (args.size() > 2 && !resizeFilterNamed(args[2])) {
+        throw std::runtime_error("Error: Invalid resize filter: " + args[2]);
+    }
 }
 
 void validateCutfreq(const std::vector<std::string>& args) {
@@ -0,0 +1,112 @@
+#include "ratioresize.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace {
+  constexpr double maxStep = 4;
+  constexpr uint maxUpShift = 2;
+
+  // Source samples of one output along an axis and the weight of high in 1 / 2^upShift
+  struct AxisTap {
+      size_t low  = 0;
+      size_t high = 0;
+      uint weight = 0;
+  };
+
+  AxisTap axisTap(RatioAxis const & axis, size_t const output) {
+    size_t const low = (output >> axis.upShift) * axis.step;
+    return {.low    = low,
+            .high   = std::min(low + 1, axis.sourceSize - 1),
+            .weight = static_cast<uint>(output & ((size_t{1} << axis.upShift) - 1))};
+  }
+
+  // Blend of two samples in units of 1 / 2^shift, rounded back to samples after each pass
+  template <RatioRounding Rounding>
+  uint pass(uint const low, uint const high, uint const weight, uint const shift) {
+    uint const sum = (((1U << shift) - weight) * low) + (weight * high);
+    if constexpr (Rounding == RatioRounding::perPass) {
+      return (sum + ((1U << shift) >> 1U)) >> shift;
+    } else {
+      return sum;
+    }
+  }
+
+  template <typename Sample, RatioRounding Rounding>
+  void ratioRows(std::span<Sample const> const source, RatioPlan const & plan,
+                 RowRange const rows, std::span<Sample> const output) {
+    size_t const channels     = plan.channels;
+    size_t const sourceStride = plan.columns.sourceSize * channels;
+    size_t const stride       = plan.columns.outputs * channels;
+    uint const columnShift    = plan.columns.upShift;
+    uint const rowShift       = plan.rows.upShift;
+    // With a single rounding both passes are summed in units of 1 / 2^(columnShift + rowShift)
+    uint const finalShift = Rounding == RatioRounding::once ? columnShift + rowShift : rowShift;
+    bool const sameColumns = plan.columns.step == 1 && columnShift == 0;
+    for (size_t row = rows.first; row < rows.first + rows.count; ++row) {
+      AxisTap const vertical      = axisTap(plan.rows, row);
+      Sample const * const top    = source.data() + (vertical.low * sourceStride);
+      Sample const * const bottom = source.data() + (vertical.high * sourceStride);
+      Sample * const out          = output.data() + (row * stride);
+      if (sameColumns && vertical.weight == 0) {
+        std::copy(top, top + stride, out);
+        continue;
+      }
+      for (size_t column = 0; column < plan.columns.outputs; ++column) {
+        AxisTap const horizontal = axisTap(plan.columns, column);
+        for (size_t channel = 0; channel < channels; ++channel) {
+          size_t const left  = (horizontal.low * channels) + channel;
+          size_t const right = (horizontal.high * channels) + channel;
+          uint const upper =
+            pass<Rounding>(top[left], top[right], horizontal.weight, columnShift);
+          uint const lower =
+            pass<Rounding>(bottom[left], bottom[right], horizontal.weight, columnShift);
+          uint const sum = (((1U << rowShift) - vertical.weight) * upper) +
+                           (vertical.weight * lower);
+          out[(column * channels) + channel] =
+            static_cast<Sample>((sum + ((1U << finalShift) >> 1U)) >> finalShift);
+        }
+      }
+    }
+  }
+
+  template <typename Sample>
+  void ratioResizeRows(std::span<Sample const> const source, RatioPlan const & plan,
+                       RowRange const rows, std::span<Sample> const output) {
+    if (plan.rounding == RatioRounding::once) {
+      ratioRows<Sample, RatioRounding::once>(source, plan, rows, output);
+    } else {
+      ratioRows<Sample, RatioRounding::perPass>(source, plan, rows, output);
+    }
+  }
+}  // namespace
+
+std::optional<RatioAxis> ratioAxis(double const step, size_t const sourceSize,
+                                   size_t const outputs) {
+  // Also rejects the infinite or NaN steps of one-sample outputs
+  if (sourceSize == 0 || outputs == 0 || !(step > 0) || step > maxStep) { return std::nullopt; }
+  RatioAxis axis = {.sourceSize = sourceSize, .outputs = outputs, .step = 1, .upShift = 0};
+  if (step >= 1) {
+    auto const whole = static_cast<size_t>(step);
+    if (static_cast<double>(whole) != step || !std::has_single_bit(whole)) { return std::nullopt; }
+    axis.step = whole;
+  } else {
+    while (axis.upShift < maxUpShift && static_cast<double>(1U << axis.upShift) * step < 1) {
+      ++axis.upShift;
+    }
+    if (static_cast<double>(1U << axis.upShift) * step != 1) { return std::nullopt; }
+  }
+  // Every sample read must lie in the source
+  if (((outputs - 1) >> axis.upShift) * axis.step >= sourceSize) { return std::nullopt; }
+  return axis;
+}
+
+void ratioResize(std::span<uint8_t const> const source, RatioPlan const & plan,
+                 RowRange const rows, std::span<uint8_t> const output) {
+  ratioResizeRows(source, plan, rows, output);
+}
+
+void ratioResize(std::span<uint16_t const> const source, RatioPlan const & plan,
+                 RowRange const rows, std::span<uint16_t> const output) {
+  ratioResizeRows(source, plan, rows, output);
+}
@@ -0,0 +1,49 @@
+#ifndef RATIORESIZE_HPP
+#define RATIORESIZE_HPP
+
+#include "simdkernels.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <sys/types.h>
+
+// Bilinear resize along axes whose output positions step through the source by exactly 4, 2, 1,
+// 1/2 or 1/4 samples. Every bilinear weight is then a multiple of 1/4, so the double
+// interpolation of ImageSOA and resizeImage is exact and the same rounded samples come out of
+// integer sums and shifts. Reductions only pick samples, same-size rows are copied.
+
+// Output i of an axis reads source (i >> upShift) * step and, when enlarging, blends in the next
+// sample (the last one at the edge) with weight (i mod 2^upShift) / 2^upShift
+struct RatioAxis {
+    size_t sourceSize = 0;
+    size_t outputs    = 0;
+    // 1, 2 or 4 when reducing, 1 otherwise
+    size_t step  = 1;
+    // 1 or 2 when enlarging, 0 otherwise
+    uint upShift = 0;
+};
+
+// The axis of a bilinear resize stepping through sourceSize samples by step for every one of
+// outputs samples, or nullopt when step is not one of the ratios above
+std::optional<RatioAxis> ratioAxis(double step, size_t sourceSize, size_t outputs);
+
+// ImageSOA rounds the interpolated value once; resizeImage rounds after each pass
+enum class RatioRounding : uint8_t { once, perPass };
+
+// Both axes and the interleaved samples per pixel (1 for a channel, 3 for RGB pixels)
+struct RatioPlan {
+    RatioAxis columns;
+    RatioAxis rows;
+    size_t channels        = 1;
+    RatioRounding rounding = RatioRounding::once;
+};
+
+// Given output rows of an image; bands of one resize can run on different threads
+void ratioResize(std::span<uint8_t const> source, RatioPlan const & plan, RowRange rows,
+                 std::span<uint8_t> output);
+void ratioResize(std::span<uint16_t const> source, RatioPlan const & plan, RowRange rows,
+                 std::span<uint16_t> output);
+
+#endif //RATIORESIZE_HPP
@@ -0,0 +1,249 @@
+#include "resample.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+namespace {
+  // Keys cubic with a = -0.5 (Catmull-Rom), zero at every nonzero integer
+  constexpr double bicubicA = -0.5;
+  constexpr double bicubicSupport = 2;
+  constexpr double lanczosLobes = 3;
+
+  double sinc(double const x_value) {
+    if (x_value == 0) { return 1; }
+    double const angle = std::numbers::pi * x_value;
+    return std::sin(angle) / angle;
+  }
+
+  // Weight of a source sample at distance x_value (in filter units) from the output centre
+  double filterWeight(ResizeFilter const filter, double const x_value) {
+    double const distance = std::abs(x_value);
+    if (filter == ResizeFilter::bicubic) {
+      if (distance < 1) {
+        return ((((bicubicA + 2) * distance) - (bicubicA + 3)) * distance * distance) + 1;
+      }
+      if (distance < bicubicSupport) {
+        return bicubicA * ((((distance - 5) * distance) + 8) * distance - 4);
+      }
+      return 0;
+    }
+    if (distance < lanczosLobes) { return sinc(distance) * sinc(distance / lanczosLobes); }
+    return 0;
+  }
+
+  // Source positions first .. first + weights.size() - 1 of one output and their weights
+  struct Kernel {
+      size_t first = 0;
+      std::vector<double> weights;
+  };
+
+  // Nearest: the source sample under the output centre
+  Kernel nearestKernel(size_t const output, size_t const sourceSize, double const scale) {
+    auto const centre = static_cast<size_t>((static_cast<double>(output) + 0.5) * scale);
+    return {.first = std::min(centre, sourceSize - 1), .weights = {1}};
+  }
+
+  // Box: every source sample weighted by how much of it the output pixel covers
+  Kernel boxKernel(size_t const output, size_t const sourceSize, double const scale) {
+    double const begin = static_cast<double>(output) * scale;
+    double const end   = std::min(begin + scale, static_cast<double>(sourceSize));
+    Kernel kernel{.first = std::min(static_cast<size_t>(begin), sourceSize - 1), .weights = {}};
+    for (size_t sample = kernel.first; static_cast<double>(sample) < end; ++sample) {
+      double const low  = std::max(begin, static_cast<double>(sample));
+      double const high = std::min(end, static_cast<double>(sample + 1));
+      kernel.weights.push_back(high - low);
+    }
+    return kernel;
+  }
+
+  // Bicubic and Lanczos: the filter stretched by the reduction factor, cut at the image edges
+  Kernel convolutionKernel(ResizeFilter const filter, size_t const output,
+                           size_t const sourceSize, double const scale) {
+    double const stretch = std::max(scale, 1.0);
+    double const support =
+      (filter == ResizeFilter::bicubic ? bicubicSupport : lanczosLobes) * stretch;
+    double const centre = (static_cast<double>(output) + 0.5) * scale;
+    auto const first    = static_cast<size_t>(std::max(0.0, std::floor(centre - support + 0.5)));
+    size_t const end    = std::min(sourceSize, static_cast<size_t>(std::max(
+                                                  0.0, std::floor(centre + support + 0.5))));
+    Kernel kernel{.first = std::min(first, sourceSize - 1), .weights = {}};
+    for (size_t sample = kernel.first; sample < end; ++sample) {
+      kernel.weights.push_back(
+        filterWeight(filter, (static_cast<double>(sample) + 0.5 - centre) / stretch));
+    }
+    if (kernel.weights.empty()) { kernel.weights.push_back(1); }
+    return kernel;
+  }
+
+  Kernel kernelOf(ResizeFilter const filter, size_t const output, size_t const sourceSize,
+                  double const scale) {
+    switch (filter) {
+      case ResizeFilter::nearest:
+        return nearestKernel(output, sourceSize, scale);
+      case ResizeFilter::box:
+        return boxKernel(output, sourceSize, scale);
+      case ResizeFilter::bicubic:
+      case ResizeFilter::lanczos3:
+        return convolutionKernel(filter, output, sourceSize, scale);
+      case ResizeFilter::bilinear:
+        break;
+    }
+    throw std::invalid_argument("bilinear resize has no resample kernels");
+  }
+
+  // Horizontal pass: the filtered samples of the given source rows into blended, one
+  // row of columns.first.size() * channels samples after another
+  template <typename Sample>
+  void filterRows(std::span<Sample const> const source, ResamplePlan const & plan,
+                  RowRange const rows, std::span<float> const blended) {
+    ResampleKernels const & columns = plan.columns;
+    size_t const channels           = plan.channels;
+    size_t const sourceStride       = plan.rowLength * channels;
+    size_t const blendedStride      = columns.first.size() * channels;
+    for (size_t row = 0; row < rows.count; ++row) {
+      Sample const * const input = source.data() + ((rows.first + row) * sourceStride);
+      float * const out          = blended.data() + (row * blendedStride);
+      for (size_t column = 0; column < columns.first.size(); ++column) {
+        float const * const weights = columns.weights.data() + (column * columns.taps);
+        Sample const * const taps   = input + (columns.first[column] * channels);
+        for (size_t channel = 0; channel < channels; ++channel) {
+          float sum = 0;
+          for (size_t tap = 0; tap < columns.count[column]; ++tap) {
+            sum += weights[tap] * static_cast<float>(taps[(tap * channels) + channel]);
+          }
+          out[(column * channels) + channel] = sum;
+        }
+      }
+    }
+  }
+
+  // Whether kernels take every pair of samples 2i, 2i + 1 to output i with equal weights: the box
+  // filter on a size halved exactly
+  bool halves(ResampleKernels const & kernels, size_t const sourceSize) {
+    if (kernels.taps != 2 || kernels.first.size() * 2 != sourceSize) { return false; }
+    for (size_t output = 0; output < kernels.first.size(); ++output) {
+      if (kernels.first[output] != 2 * output || kernels.count[output] != 2 ||
+          kernels.weights[2 * output] != kernels.weights[(2 * output) + 1]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // 2:1 reduction in both directions: each output sample is the rounded mean of a 2 x 2 block,
+  // clamped like the separable passes, which give the same value with twice the arithmetic
+  template <typename Sample>
+  void halveRows(std::span<Sample const> const source, ResamplePlan const & plan,
+                 RowRange const rows, std::span<Sample> const output) {
+    size_t const channels     = plan.channels;
+    size_t const sourceStride = plan.rowLength * channels;
+    size_t const stride       = plan.columns.first.size() * channels;
+    for (size_t row = rows.first; row < rows.first + rows.count; ++row) {
+      Sample const * const top    = source.data() + (2 * row * sourceStride);
+      Sample const * const bottom = top + sourceStride;
+      Sample * const out          = output.data() + (row * stride);
+      for (size_t column = 0; column < plan.columns.first.size(); ++column) {
+        for (size_t channel = 0; channel < channels; ++channel) {
+          size_t const left  = (2 * column * channels) + channel;
+          size_t const right = left + channels;
+          uint const sum     = uint{top[left]} + top[right] + bottom[left] + bottom[right];
+          out[(column * channels) + channel] =
+            static_cast<Sample>(std::min((sum + 2) / 4, plan.maxValue));
+        }
+      }
+    }
+  }
+
+  template <typename Sample>
+  void resampleRows(std::span<Sample const> const source, ResamplePlan const & plan,
+                    RowRange const rows, std::span<Sample> const output) {
+    if (rows.count == 0) { return; }
+    if (halves(plan.columns, plan.rowLength) &&
+        halves(plan.rows, source.size() / (plan.rowLength * plan.channels))) {
+      halveRows(source, plan, rows, output);
+      return;
+    }
+    ResampleKernels const & kernels = plan.rows;
+    // Source rows read by this band of output rows
+    size_t const firstSource = kernels.first[rows.first];
+    size_t endSource         = firstSource;
+    for (size_t row = rows.first; row < rows.first + rows.count; ++row) {
+      endSource = std::max(endSource, kernels.first[row] + kernels.count[row]);
+    }
+    size_t const stride = plan.columns.first.size() * plan.channels;
+    std::vector<float> blended((endSource - firstSource) * stride);
+    filterRows(source, plan, RowRange{.first = firstSource, .count = endSource - firstSource},
+               std::span<float>(blended));
+
+    // Vertical pass: whole rows are accumulated tap by tap, so the inner loop runs over
+    // contiguous samples
+    auto const maxValue = static_cast<float>(plan.maxValue);
+    std::vector<float> sums(stride);
+    for (size_t row = rows.first; row < rows.first + rows.count; ++row) {
+      std::ranges::fill(sums, 0.0F);
+      float const * const weights = kernels.weights.data() + (row * kernels.taps);
+      for (size_t tap = 0; tap < kernels.count[row]; ++tap) {
+        float const * const input =
+          blended.data() + ((kernels.first[row] + tap - firstSource) * stride);
+        for (size_t sample = 0; sample < stride; ++sample) {
+          sums[sample] += weights[tap] * input[sample];
+        }
+      }
+      Sample * const out = output.data() + (row * stride);
+      for (size_t sample = 0; sample < stride; ++sample) {
+        out[sample] = static_cast<Sample>(std::clamp(sums[sample], 0.0F, maxValue) + 0.5F);
+      }
+    }
+  }
+}  // namespace
+
+std::optional<ResizeFilter> resizeFilterNamed(std::string_view const name) {
+  if (name == "bilinear") { return ResizeFilter::bilinear; }
+  if (name == "nearest") { return ResizeFilter::nearest; }
+  if (name == "box") { return ResizeFilter::box; }
+  if (name == "bicubic") { return ResizeFilter::bicubic; }
+  if (name == "lanczos3") { return ResizeFilter::lanczos3; }
+  return std::nullopt;
+}
+
+ResampleKernels resampleKernels(ResizeFilter const filter, size_t const outputs,
+                                size_t const sourceSize) {
+  if (outputs == 0 || sourceSize == 0) {
+    throw std::invalid_argument("Cannot resample to or from an empty size");
+  }
+  double const scale = static_cast<double>(sourceSize) / static_cast<double>(outputs);
+  std::vector<Kernel> kernels;
+  kernels.reserve(outputs);
+  ResampleKernels result;
+  for (size_t output = 0; output < outputs; ++output) {
+    kernels.push_back(kernelOf(filter, output, sourceSize, scale));
+    result.taps = std::max(result.taps, kernels.back().weights.size());
+  }
+  result.first.reserve(outputs);
+  result.count.reserve(outputs);
+  result.weights.assign(outputs * result.taps, 0.0F);
+  for (size_t output = 0; output < outputs; ++output) {
+    Kernel const & kernel = kernels[output];
+    double total          = 0;
+    for (double const weight : kernel.weights) { total += weight; }
+    result.first.push_back(kernel.first);
+    result.count.push_back(kernel.weights.size());
+    for (size_t tap = 0; tap < kernel.weights.size(); ++tap) {
+      result.weights[(output * result.taps) + tap] =
+        static_cast<float>(kernel.weights[tap] / total);
+    }
+  }
+  return result;
+}
+
+void resample(std::span<uint8_t const> const source, ResamplePlan const & plan,
+              RowRange const rows, std::span<uint8_t> const output) {
+  resampleRows(source, plan, rows, output);
+}
+
+void resample(std::span<uint16_t const> const source, ResamplePlan const & plan,
+              RowRange const rows, std::span<uint16_t> const output) {
+  resampleRows(source, plan, rows, output);
+}
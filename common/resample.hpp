@@ -0,0 +1,60 @@
+#ifndef RESAMPLE_HPP
+#define RESAMPLE_HPP
+
+#include "simdkernels.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <sys/types.h>
+#include <vector>
+
+// Resampling filters of resize. bilinear is the original interpolation, with its own code and
+// geometry in each image class. The others are separable: a horizontal pass over every source
+// row a band of output rows needs, then a vertical pass per output row, both driven by weights
+// computed once per output column and row. Pixel centres are aligned (output i is centred on
+// source (i + 0.5) * sourceSize / outputs), and results are rounded and clamped to the image's
+// maximum value.
+//
+// box averages the source area each output pixel covers, reading every source sample once per
+// pass however large the reduction, so it is the fast path for thumbnails. bicubic (Keys,
+// a = -0.5) and lanczos3 widen with the reduction factor and cost proportionally more. A box
+// reduction to exactly half the width and height takes an integer 2 x 2 kernel with the same
+// result.
+enum class ResizeFilter : uint8_t { bilinear, nearest, box, bicubic, lanczos3 };
+
+// Filter named by the optional resize argument: "bilinear", "nearest", "box", "bicubic" or
+// "lanczos3"
+std::optional<ResizeFilter> resizeFilterNamed(std::string_view name);
+
+// Output i of a pass is the sum of weights[i * taps + k] * source[first[i] + k] for k below
+// count[i]; the weights of each output add up to 1
+struct ResampleKernels {
+    std::vector<size_t> first;
+    std::vector<size_t> count;
+    std::vector<float> weights;
+    size_t taps = 0;
+};
+
+// Kernels of filter (any but bilinear) taking sourceSize samples to outputs samples
+ResampleKernels resampleKernels(ResizeFilter filter, size_t outputs, size_t sourceSize);
+
+// Kernels along a row (columns) and a column (rows), the pixels per source row, the interleaved
+// samples per pixel (1 for a channel, 3 for RGB pixels) and the largest output sample
+struct ResamplePlan {
+    ResampleKernels columns;
+    ResampleKernels rows;
+    size_t rowLength = 0;
+    size_t channels  = 1;
+    uint maxValue    = 0;
+};
+
+// Given output rows of an image; bands of one resize can run on different threads
+void resample(std::span<uint8_t const> source, ResamplePlan const & plan, RowRange rows,
+              std::span<uint8_t> output);
+void resample(std::span<uint16_t const> source, ResamplePlan const & plan, RowRange rows,
+              std::span<uint16_t> output);
+
+#endif //RESAMPLE_HPP
@@ -0,0 +1,690 @@
+#include "simdkernels.hpp"
+
+#include "leveltable.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  // GCC's AVX-512 intrinsics start from a deliberately undefined vector, which trips
+  // -Wmaybe-uninitialized once inlined
+  #pragma GCC diagnostic push
+  #if !defined(__clang__)
+    #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+  #endif
+  #include <immintrin.h>
+  #pragma GCC diagnostic pop
+  #define SIMDKERNELS_X86 1
+#endif
+
+// NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+namespace {
+  constexpr uint colorBits  = 24;
+  constexpr uint wordShift  = 5;
+  constexpr uint wordMask   = 31;
+  constexpr uint redShift   = 16;
+  constexpr uint greenShift = 8;
+
+  uint colorIndex(uint8_t const red, uint8_t const green, uint8_t const blue) {
+    return (uint{red} << redShift) | (uint{green} << greenShift) | uint{blue};
+  }
+
+  SimdLevel detect() {
+#if SIMDKERNELS_X86
+    // Needed when called from a static initializer, before the runtime has run it
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") != 0 && __builtin_cpu_supports("avx512bw") != 0) {
+      return SimdLevel::avx512;
+    }
+    if (__builtin_cpu_supports("avx2") != 0) { return SimdLevel::avx2; }
+    if (__builtin_cpu_supports("sse2") != 0) { return SimdLevel::sse2; }
+#endif
+    return SimdLevel::scalar;
+  }
+
+  SimdLevel const detected = detect();
+  SimdLevel active         = detected;
+
+  // Same expression as maxLevelTable, for the few samples after the last full vector
+  template <typename In, typename Out>
+  void scaleTail(std::span<In const> const input, std::span<Out> const output, size_t const from,
+                 float const factor) {
+    for (size_t i = from; i < input.size(); ++i) {
+      output[i] = static_cast<Out>(std::floor(static_cast<float>(input[i]) * factor));
+    }
+  }
+
+  constexpr uint32_t weightOne = uint32_t{1} << bilinearWeightBits;
+  // Bytes a 32-bit gather reads from each sample
+  constexpr size_t gatherBytes = 4;
+
+  // Fractional bits bilinear keeps between its passes: 8-bit products leave room for 8, 16-bit
+  // products only for whole samples
+  template <typename Sample>
+  constexpr uint fractionBits = sizeof(Sample) == 1 ? 8 : 0;
+
+  template <typename Sample>
+  constexpr uint rowShift = bilinearWeightBits - fractionBits<Sample>;
+
+  template <typename Sample>
+  constexpr uint outputShift = bilinearWeightBits + fractionBits<Sample>;
+
+  // (first * (1 - weight) + second * weight) rounded down by shift bits; below 2^32 for samples
+  // of up to 16 bits
+  uint32_t blend(uint32_t const first, uint32_t const second, uint32_t const weight,
+                 uint const shift) {
+    uint32_t const sum = (first * (weightOne - weight)) + (second * weight);
+    return (sum + (1U << (shift - 1))) >> shift;
+  }
+
+  // Index from which blendRow must take the scalar path, so no gather reads past the row
+  template <typename Sample>
+  size_t gatherLimit(std::span<Sample const> const row) {
+    if (row.size() * sizeof(Sample) < gatherBytes) { return 0; }
+    return row.size() - (gatherBytes / sizeof(Sample));
+  }
+
+#if SIMDKERNELS_X86
+  // floor(x * factor) equals truncation for the non-negative products maxlevel works with, so the
+  // vector versions convert with cvttps and keep the low bits of each result like the scalar cast
+
+  template <typename In>
+  __attribute__((target("sse2"))) void scaleLoadSse2(In const * source, __m128i & low,
+                                                     __m128i & high) {
+    __m128i const zero = _mm_setzero_si128();
+    __m128i wide{};
+    if constexpr (sizeof(In) == 1) {
+      wide = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<__m128i const *>(source)), zero);
+    } else {
+      wide = _mm_loadu_si128(reinterpret_cast<__m128i const *>(source));
+    }
+    low  = _mm_unpacklo_epi16(wide, zero);
+    high = _mm_unpackhi_epi16(wide, zero);
+  }
+
+  template <typename In, typename Out>
+  __attribute__((target("sse2"))) size_t scaleSse2(std::span<In const> const input,
+                                                   std::span<Out> const output,
+                                                   float const factor) {
+    constexpr size_t step  = 8;
+    __m128 const scale     = _mm_set1_ps(factor);
+    __m128i const lowBits  = _mm_set1_epi32(sizeof(Out) == 1 ? 0xFF : 0xFFFF);
+    __m128i const bias32   = _mm_set1_epi32(0x8000);
+    __m128i const bias16   = _mm_set1_epi16(static_cast<int16_t>(0x8000));
+    size_t done            = 0;
+    for (; done + step <= input.size(); done += step) {
+      __m128i low{};
+      __m128i high{};
+      scaleLoadSse2(input.data() + done, low, high);
+      low  = _mm_and_si128(_mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(low), scale)), lowBits);
+      high = _mm_and_si128(_mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(high), scale)), lowBits);
+      if constexpr (sizeof(Out) == 1) {
+        __m128i const words = _mm_packs_epi32(low, high);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(output.data() + done),
+                         _mm_packus_epi16(words, words));
+      } else {
+        // SSE2 only packs with signed saturation: shift into the signed range and back
+        __m128i const words =
+          _mm_packs_epi32(_mm_sub_epi32(low, bias32), _mm_sub_epi32(high, bias32));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output.data() + done),
+                         _mm_xor_si128(words, bias16));
+      }
+    }
+    return done;
+  }
+
+  template <typename In, typename Out>
+  __attribute__((target("avx2"))) size_t scaleAvx2(std::span<In const> const input,
+                                                   std::span<Out> const output,
+                                                   float const factor) {
+    constexpr size_t step = 8;
+    __m256 const scale    = _mm256_set1_ps(factor);
+    __m256i const lowBits = _mm256_set1_epi32(sizeof(Out) == 1 ? 0xFF : 0xFFFF);
+    size_t done           = 0;
+    for (; done + step <= input.size(); done += step) {
+      __m256i wide{};
+      if constexpr (sizeof(In) == 1) {
+        wide = _mm256_cvtepu8_epi32(
+          _mm_loadl_epi64(reinterpret_cast<__m128i const *>(input.data() + done)));
+      } else {
+        wide = _mm256_cvtepu16_epi32(
+          _mm_loadu_si128(reinterpret_cast<__m128i const *>(input.data() + done)));
+      }
+      wide = _mm256_and_si256(_mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(wide), scale)),
+                              lowBits);
+      __m128i const words =
+        _mm_packus_epi32(_mm256_castsi256_si128(wide), _mm256_extracti128_si256(wide, 1));
+      if constexpr (sizeof(Out) == 1) {
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(output.data() + done),
+                         _mm_packus_epi16(words, words));
+      } else {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output.data() + done), words);
+      }
+    }
+    return done;
+  }
+
+  template <typename In, typename Out>
+  __attribute__((target("avx512f,avx512bw"))) size_t scaleAvx512(std::span<In const> const input,
+                                                                  std::span<Out> const output,
+                                                                  float const factor) {
+    constexpr size_t step = 16;
+    __m512 const scale    = _mm512_set1_ps(factor);
+    size_t done           = 0;
+    for (; done + step <= input.size(); done += step) {
+      __m512i wide{};
+      if constexpr (sizeof(In) == 1) {
+        wide = _mm512_cvtepu8_epi32(
+          _mm_loadu_si128(reinterpret_cast<__m128i const *>(input.data() + done)));
+      } else {
+        wide = _mm512_cvtepu16_epi32(
+          _mm256_loadu_si256(reinterpret_cast<__m256i const *>(input.data() + done)));
+      }
+      wide = _mm512_cvttps_epi32(_mm512_mul_ps(_mm512_cvtepi32_ps(wide), scale));
+      // vpmovdb / vpmovdw keep the low bits of every lane
+      if constexpr (sizeof(Out) == 1) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output.data() + done),
+                         _mm512_cvtepi32_epi8(wide));
+      } else {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output.data() + done),
+                            _mm512_cvtepi32_epi16(wide));
+      }
+    }
+    return done;
+  }
+
+  // Lanes where |first - second| >= limit, as a movemask (one bit per byte); limit - 1 fits in a
+  // sample
+  template <typename Sample>
+  __attribute__((target("sse2"))) size_t differenceSse2(std::span<Sample const> const first,
+                                                        std::span<Sample const> const second,
+                                                        uint const limit) {
+    constexpr size_t step = 16 / sizeof(Sample);
+    __m128i const zero    = _mm_setzero_si128();
+    __m128i const below   = sizeof(Sample) == 1 ? _mm_set1_epi8(static_cast<char>(limit - 1))
+                                                : _mm_set1_epi16(static_cast<int16_t>(limit - 1));
+    size_t done           = 0;
+    for (; done + step <= first.size(); done += step) {
+      __m128i const left  = _mm_loadu_si128(reinterpret_cast<__m128i const *>(first.data() + done));
+      __m128i const right = _mm_loadu_si128(reinterpret_cast<__m128i const *>(second.data() + done));
+      __m128i over{};
+      if constexpr (sizeof(Sample) == 1) {
+        __m128i const diff = _mm_or_si128(_mm_subs_epu8(left, right), _mm_subs_epu8(right, left));
+        over               = _mm_cmpeq_epi8(_mm_subs_epu8(diff, below), zero);
+      } else {
+        __m128i const diff =
+          _mm_or_si128(_mm_subs_epu16(left, right), _mm_subs_epu16(right, left));
+        over = _mm_cmpeq_epi16(_mm_subs_epu16(diff, below), zero);
+      }
+      auto const mask = static_cast<uint>(~_mm_movemask_epi8(over)) & 0xFFFFU;
+      if (mask != 0) { return done + (static_cast<size_t>(std::countr_zero(mask)) / sizeof(Sample)); }
+    }
+    return done;
+  }
+
+  template <typename Sample>
+  __attribute__((target("avx2"))) size_t differenceAvx2(std::span<Sample const> const first,
+                                                        std::span<Sample const> const second,
+                                                        uint const limit) {
+    constexpr size_t step = 32 / sizeof(Sample);
+    __m256i const zero    = _mm256_setzero_si256();
+    __m256i const below   = sizeof(Sample) == 1
+                            ? _mm256_set1_epi8(static_cast<char>(limit - 1))
+                            : _mm256_set1_epi16(static_cast<int16_t>(limit - 1));
+    size_t done           = 0;
+    for (; done + step <= first.size(); done += step) {
+      __m256i const left =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(first.data() + done));
+      __m256i const right =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(second.data() + done));
+      __m256i over{};
+      if constexpr (sizeof(Sample) == 1) {
+        __m256i const diff =
+          _mm256_or_si256(_mm256_subs_epu8(left, right), _mm256_subs_epu8(right, left));
+        over = _mm256_cmpeq_epi8(_mm256_subs_epu8(diff, below), zero);
+      } else {
+        __m256i const diff =
+          _mm256_or_si256(_mm256_subs_epu16(left, right), _mm256_subs_epu16(right, left));
+        over = _mm256_cmpeq_epi16(_mm256_subs_epu16(diff, below), zero);
+      }
+      auto const mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(over));
+      if (mask != 0) { return done + (static_cast<size_t>(std::countr_zero(mask)) / sizeof(Sample)); }
+    }
+    return done;
+  }
+
+  template <typename Sample>
+  __attribute__((target("avx512f,avx512bw"))) size_t
+    differenceAvx512(std::span<Sample const> const first, std::span<Sample const> const second,
+                     uint const limit) {
+    constexpr size_t step = 64 / sizeof(Sample);
+    size_t done           = 0;
+    for (; done + step <= first.size(); done += step) {
+      __m512i const left  = _mm512_loadu_si512(first.data() + done);
+      __m512i const right = _mm512_loadu_si512(second.data() + done);
+      uint64_t mask       = 0;
+      if constexpr (sizeof(Sample) == 1) {
+        __m512i const diff =
+          _mm512_or_si512(_mm512_subs_epu8(left, right), _mm512_subs_epu8(right, left));
+        __m512i const over =
+          _mm512_subs_epu8(diff, _mm512_set1_epi8(static_cast<char>(limit - 1)));
+        mask = _mm512_test_epi8_mask(over, over);
+      } else {
+        __m512i const diff =
+          _mm512_or_si512(_mm512_subs_epu16(left, right), _mm512_subs_epu16(right, left));
+        __m512i const over =
+          _mm512_subs_epu16(diff, _mm512_set1_epi16(static_cast<int16_t>(limit - 1)));
+        mask = _mm512_test_epi16_mask(over, over);
+      }
+      if (mask != 0) { return done + static_cast<size_t>(std::countr_zero(mask)); }
+    }
+    return done;
+  }
+
+  __attribute__((target("avx2"))) __m256i loadWideAvx2(uint8_t const * source) {
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const *>(source)));
+  }
+
+  __attribute__((target("avx512f"))) __m512i loadWideAvx512(uint8_t const * source) {
+    return _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const *>(source)));
+  }
+
+  // Gather the bitmap word of 8 / 16 pixels at a time and test each pixel's bit
+  __attribute__((target("avx2"))) size_t markedAvx2(Planes8 const & planes,
+                                                    ColorMarks const & marks, size_t from) {
+    constexpr size_t step = 8;
+    auto const * words    = reinterpret_cast<int const *>(marks.words().data());
+    __m256i const one     = _mm256_set1_epi32(1);
+    __m256i const low     = _mm256_set1_epi32(static_cast<int>(wordMask));
+    for (; from + step <= planes.red.size(); from += step) {
+      __m256i const key = _mm256_or_si256(
+        _mm256_or_si256(_mm256_slli_epi32(loadWideAvx2(planes.red.data() + from), redShift),
+                        _mm256_slli_epi32(loadWideAvx2(planes.green.data() + from), greenShift)),
+        loadWideAvx2(planes.blue.data() + from));
+      __m256i const word = _mm256_i32gather_epi32(words, _mm256_srli_epi32(key, wordShift), 4);
+      __m256i const bit  = _mm256_sllv_epi32(one, _mm256_and_si256(key, low));
+      __m256i const miss = _mm256_cmpeq_epi32(_mm256_and_si256(word, bit), _mm256_setzero_si256());
+      auto const mask    = static_cast<uint>(~_mm256_movemask_ps(_mm256_castsi256_ps(miss))) & 0xFFU;
+      if (mask != 0) { return from + static_cast<size_t>(std::countr_zero(mask)); }
+    }
+    return from;
+  }
+
+  __attribute__((target("avx512f,avx512bw"))) size_t
+    markedAvx512(Planes8 const & planes, ColorMarks const & marks, size_t from) {
+    constexpr size_t step = 16;
+    void const * words    = marks.words().data();
+    __m512i const one     = _mm512_set1_epi32(1);
+    __m512i const low     = _mm512_set1_epi32(static_cast<int>(wordMask));
+    for (; from + step <= planes.red.size(); from += step) {
+      __m512i const key = _mm512_or_si512(
+        _mm512_or_si512(_mm512_slli_epi32(loadWideAvx512(planes.red.data() + from), redShift),
+                        _mm512_slli_epi32(loadWideAvx512(planes.green.data() + from), greenShift)),
+        loadWideAvx512(planes.blue.data() + from));
+      __m512i const word = _mm512_i32gather_epi32(_mm512_srli_epi32(key, wordShift), words, 4);
+      __m512i const bit  = _mm512_sllv_epi32(one, _mm512_and_si512(key, low));
+      if (__mmask16 const mask = _mm512_test_epi32_mask(word, bit); mask != 0) {
+        return from + static_cast<size_t>(std::countr_zero(static_cast<uint>(mask)));
+      }
+    }
+    return from;
+  }
+
+  // Fixed-point bilinear passes. SSE2 has neither gathers nor 32-bit multiplies, so it uses the
+  // scalar loops.
+
+  template <typename Sample>
+  __attribute__((target("avx2"))) size_t blendRowAvx2(std::span<Sample const> const row,
+                                                      BilinearTaps const & taps,
+                                                      std::span<uint32_t> const blended) {
+    constexpr size_t step    = 8;
+    constexpr int scale      = sizeof(Sample);
+    auto const * base        = reinterpret_cast<int const *>(row.data());
+    __m256i const limit      = _mm256_set1_epi32(static_cast<int>(gatherLimit(row)));
+    __m256i const one        = _mm256_set1_epi32(static_cast<int>(weightOne));
+    __m256i const half       = _mm256_set1_epi32(1 << (rowShift<Sample> - 1));
+    __m256i const sampleMask = _mm256_set1_epi32(sizeof(Sample) == 1 ? 0xFF : 0xFFFF);
+    size_t done              = 0;
+    for (; done + step <= blended.size(); done += step) {
+      __m256i const low =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(taps.low.data() + done));
+      __m256i const high =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(taps.high.data() + done));
+      __m256i const reach = _mm256_max_epu32(low, high);
+      if (_mm256_movemask_epi8(_mm256_cmpgt_epi32(reach, limit)) != 0) { break; }
+      __m256i const weight =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(taps.weight.data() + done));
+      __m256i const first =
+        _mm256_and_si256(_mm256_i32gather_epi32(base, low, scale), sampleMask);
+      __m256i const second =
+        _mm256_and_si256(_mm256_i32gather_epi32(base, high, scale), sampleMask);
+      __m256i const sum = _mm256_add_epi32(_mm256_mullo_epi32(first, _mm256_sub_epi32(one, weight)),
+                                          _mm256_mullo_epi32(second, weight));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(blended.data() + done),
+                          _mm256_srli_epi32(_mm256_add_epi32(sum, half), rowShift<Sample>));
+    }
+    return done;
+  }
+
+  template <typename Sample>
+  __attribute__((target("avx512f"))) size_t blendRowAvx512(std::span<Sample const> const row,
+                                                           BilinearTaps const & taps,
+                                                           std::span<uint32_t> const blended) {
+    constexpr size_t step    = 16;
+    constexpr int scale      = sizeof(Sample);
+    void const * base        = row.data();
+    __m512i const limit      = _mm512_set1_epi32(static_cast<int>(gatherLimit(row)));
+    __m512i const one        = _mm512_set1_epi32(static_cast<int>(weightOne));
+    __m512i const half       = _mm512_set1_epi32(1 << (rowShift<Sample> - 1));
+    __m512i const sampleMask = _mm512_set1_epi32(sizeof(Sample) == 1 ? 0xFF : 0xFFFF);
+    size_t done              = 0;
+    for (; done + step <= blended.size(); done += step) {
+      __m512i const low  = _mm512_loadu_si512(taps.low.data() + done);
+      __m512i const high = _mm512_loadu_si512(taps.high.data() + done);
+      if (_mm512_cmpgt_epi32_mask(_mm512_max_epu32(low, high), limit) != 0) { break; }
+      __m512i const weight = _mm512_loadu_si512(taps.weight.data() + done);
+      __m512i const first =
+        _mm512_and_si512(_mm512_i32gather_epi32(low, base, scale), sampleMask);
+      __m512i const second =
+        _mm512_and_si512(_mm512_i32gather_epi32(high, base, scale), sampleMask);
+      __m512i const sum = _mm512_add_epi32(_mm512_mullo_epi32(first, _mm512_sub_epi32(one, weight)),
+                                          _mm512_mullo_epi32(second, weight));
+      _mm512_storeu_si512(blended.data() + done,
+                          _mm512_srli_epi32(_mm512_add_epi32(sum, half), rowShift<Sample>));
+    }
+    return done;
+  }
+
+  template <typename Sample>
+  __attribute__((target("avx2"))) size_t blendRowsAvx2(BlendedRows const & rows,
+                                                       std::span<Sample> const output) {
+    constexpr size_t step = 8;
+    __m256i const weight  = _mm256_set1_epi32(static_cast<int>(rows.weight));
+    __m256i const other   = _mm256_set1_epi32(static_cast<int>(weightOne - rows.weight));
+    __m256i const half    = _mm256_set1_epi32(1 << (outputShift<Sample> - 1));
+    size_t done           = 0;
+    for (; done + step <= output.size(); done += step) {
+      __m256i const top =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(rows.top.data() + done));
+      __m256i const bottom =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(rows.bottom.data() + done));
+      __m256i const sum =
+        _mm256_add_epi32(_mm256_mullo_epi32(top, other), _mm256_mullo_epi32(bottom, weight));
+      __m256i const value = _mm256_srli_epi32(_mm256_add_epi32(sum, half), outputShift<Sample>);
+      __m128i const words =
+        _mm_packus_epi32(_mm256_castsi256_si128(value), _mm256_extracti128_si256(value, 1));
+      if constexpr (sizeof(Sample) == 1) {
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(output.data() + done),
+                         _mm_packus_epi16(words, words));
+      } else {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output.data() + done), words);
+      }
+    }
+    return done;
+  }
+
+  template <typename Sample>
+  __attribute__((target("avx512f"))) size_t blendRowsAvx512(BlendedRows const & rows,
+                                                            std::span<Sample> const output) {
+    constexpr size_t step = 16;
+    __m512i const weight  = _mm512_set1_epi32(static_cast<int>(rows.weight));
+    __m512i const other   = _mm512_set1_epi32(static_cast<int>(weightOne - rows.weight));
+    __m512i const half    = _mm512_set1_epi32(1 << (outputShift<Sample> - 1));
+    size_t done           = 0;
+    for (; done + step <= output.size(); done += step) {
+      __m512i const top    = _mm512_loadu_si512(rows.top.data() + done);
+      __m512i const bottom = _mm512_loadu_si512(rows.bottom.data() + done);
+      __m512i const sum =
+        _mm512_add_epi32(_mm512_mullo_epi32(top, other), _mm512_mullo_epi32(bottom, weight));
+      __m512i const value = _mm512_srli_epi32(_mm512_add_epi32(sum, half), outputShift<Sample>);
+      if constexpr (sizeof(Sample) == 1) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output.data() + done),
+                         _mm512_cvtepi32_epi8(value));
+      } else {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output.data() + done),
+                            _mm512_cvtepi32_epi16(value));
+      }
+    }
+    return done;
+  }
+#endif
+
+  template <typename Sample>
+  void blendRowWith(std::span<Sample const> const row, BilinearTaps const & taps,
+                    std::span<uint32_t> const blended) {
+    size_t done = 0;
+#if SIMDKERNELS_X86
+    if (active == SimdLevel::avx512) {
+      done = blendRowAvx512(row, taps, blended);
+    } else if (active == SimdLevel::avx2) {
+      done = blendRowAvx2(row, taps, blended);
+    }
+#endif
+    for (; done < blended.size(); ++done) {
+      blended[done] = blend(row[taps.low[done]], row[taps.high[done]], taps.weight[done],
+                            rowShift<Sample>);
+    }
+  }
+
+  template <typename Sample>
+  void blendRowsWith(BlendedRows const & rows, std::span<Sample> const output) {
+    size_t done = 0;
+#if SIMDKERNELS_X86
+    if (active == SimdLevel::avx512) {
+      done = blendRowsAvx512(rows, output);
+    } else if (active == SimdLevel::avx2) {
+      done = blendRowsAvx2(rows, output);
+    }
+#endif
+    for (; done < output.size(); ++done) {
+      output[done] = static_cast<Sample>(
+        blend(rows.top[done], rows.bottom[done], rows.weight, outputShift<Sample>));
+    }
+  }
+
+  template <typename Sample>
+  void bilinearResizeWith(std::span<Sample const> const source, BilinearPlan const & plan,
+                          RowRange const rows, std::span<Sample> const output) {
+    constexpr size_t noRow = ~size_t{0};
+    size_t const width     = plan.columns.low.size();
+    std::array<std::vector<uint32_t>, 2> blended = {std::vector<uint32_t>(width),
+                                                    std::vector<uint32_t>(width)};
+    std::array<size_t, 2> held = {noRow, noRow};
+    auto const slotOf = [&held](size_t const row) -> size_t {
+      if (held[0] == row) { return 0; }
+      return held[1] == row ? 1 : noRow;
+    };
+    auto const fill = [&](size_t const slot, size_t const row) {
+      blendRowWith(source.subspan(row * plan.rowLength, plan.rowLength), plan.columns,
+                   std::span(blended[slot]));
+      held[slot] = row;
+    };
+    for (size_t out = rows.first; out < rows.first + rows.count; ++out) {
+      size_t top = slotOf(plan.rows.low[out]);
+      if (top == noRow) {
+        top = held[0] == plan.rows.high[out] ? 1 : 0;
+        fill(top, plan.rows.low[out]);
+      }
+      size_t bottom = slotOf(plan.rows.high[out]);
+      if (bottom == noRow) {
+        bottom = 1 - top;
+        fill(bottom, plan.rows.high[out]);
+      }
+      BlendedRows const pair = {
+        .top = blended[top], .bottom = blended[bottom], .weight = plan.rows.weight[out]};
+      blendRowsWith(pair, output.subspan(out * width, width));
+    }
+  }
+
+  template <typename In, typename Out>
+  void scaleWith(std::span<In const> const input, std::span<Out> const output,
+                 LevelScale const scale) {
+    auto const factor = static_cast<float>(scale.newMax) / static_cast<float>(scale.currentMax);
+    size_t done       = 0;
+    switch (active) {
+#if SIMDKERNELS_X86
+      case SimdLevel::avx512:
+        done = scaleAvx512(input, output, factor);
+        break;
+      case SimdLevel::avx2:
+        done = scaleAvx2(input, output, factor);
+        break;
+      case SimdLevel::sse2:
+        done = scaleSse2(input, output, factor);
+        break;
+#endif
+      default:
+        applyLevelTable<In, Out>(input, output,
+                                 maxLevelTable<In, Out>(scale.currentMax, scale.newMax));
+        return;
+    }
+    scaleTail(input, output, done, factor);
+  }
+
+  template <typename Sample>
+  size_t differenceWith(std::span<Sample const> const first, std::span<Sample const> const second,
+                        uint const limit) {
+    if (limit == 0) { return 0; }
+    size_t const size = std::min(first.size(), second.size());
+    // No difference between two samples reaches the limit
+    if (limit > (1U << (8 * sizeof(Sample))) - 1) { return first.size(); }
+    size_t done = 0;
+#if SIMDKERNELS_X86
+    auto const left  = first.first(size);
+    auto const right = second.first(size);
+    switch (active) {
+      case SimdLevel::avx512:
+        done = differenceAvx512(left, right, limit);
+        break;
+      case SimdLevel::avx2:
+        done = differenceAvx2(left, right, limit);
+        break;
+      case SimdLevel::sse2:
+        done = differenceSse2(left, right, limit);
+        break;
+      default:
+        break;
+    }
+#endif
+    for (; done < size; ++done) {
+      auto const diff = first[done] > second[done] ? first[done] - second[done]
+                                                   : second[done] - first[done];
+      if (static_cast<uint>(diff) >= limit) { return done; }
+    }
+    return first.size();
+  }
+} // namespace
+
+SimdLevel detectedSimdLevel() { return detected; }
+
+SimdLevel activeSimdLevel() { return active; }
+
+SimdLevel selectSimdLevel(SimdLevel const level) {
+  active = std::min(level, detected);
+  return active;
+}
+
+void scaleSamples(std::span<uint8_t const> const input, std::span<uint8_t> const output,
+                  LevelScale const scale) {
+  scaleWith(input, output, scale);
+}
+
+void scaleSamples(std::span<uint8_t const> const input, std::span<uint16_t> const output,
+                  LevelScale const scale) {
+  scaleWith(input, output, scale);
+}
+
+void scaleSamples(std::span<uint16_t const> const input, std::span<uint16_t> const output,
+                  LevelScale const scale) {
+  scaleWith(input, output, scale);
+}
+
+void scaleSamples(std::span<uint16_t const> const input, std::span<uint8_t> const output,
+                  LevelScale const scale) {
+  scaleWith(input, output, scale);
+}
+
+size_t firstDifference(std::span<uint8_t const> const first, std::span<uint8_t const> const second,
+                       uint const limit) {
+  return differenceWith(first, second, limit);
+}
+
+size_t firstDifference(std::span<uint16_t const> const first,
+                       std::span<uint16_t const> const second, uint const limit) {
+  return differenceWith(first, second, limit);
+}
+
+ColorMarks::ColorMarks() : bits((size_t{1} << colorBits) >> wordShift) { }
+
+void ColorMarks::mark(uint8_t const red, uint8_t const green, uint8_t const blue) {
+  uint const index = colorIndex(red, green, blue);
+  bits[index >> wordShift] |= 1U << (index & wordMask);
+}
+
+bool ColorMarks::marked(uint8_t const red, uint8_t const green, uint8_t const blue) const {
+  uint const index = colorIndex(red, green, blue);
+  return ((bits[index >> wordShift] >> (index & wordMask)) & 1U) != 0;
+}
+
+uint32_t bilinearWeight(double const weight) {
+  return static_cast<uint32_t>(std::lround(weight * weightOne));
+}
+
+void blendRow(std::span<uint8_t const> const row, BilinearTaps const & taps,
+              std::span<uint32_t> const blended) {
+  blendRowWith(row, taps, blended);
+}
+
+void blendRow(std::span<uint16_t const> const row, BilinearTaps const & taps,
+              std::span<uint32_t> const blended) {
+  blendRowWith(row, taps, blended);
+}
+
+void blendRows(BlendedRows const & rows, std::span<uint8_t> const output) {
+  blendRowsWith(rows, output);
+}
+
+void blendRows(BlendedRows const & rows, std::span<uint16_t> const output) {
+  blendRowsWith(rows, output);
+}
+
+void bilinearResize(std::span<uint8_t const> const source, BilinearPlan const & plan,
+                    std::span<uint8_t> const output) {
+  bilinearResizeWith(source, plan, RowRange{.count = plan.rows.low.size()}, output);
+}
+
+void bilinearResize(std::span<uint8_t const> const source, BilinearPlan const & plan,
+                    RowRange const rows, std::span<uint8_t> const output) {
+  bilinearResizeWith(source, plan, rows, output);
+}
+
+void bilinearResize(std::span<uint16_t const> const source, BilinearPlan const & plan,
+                    std::span<uint16_t> const output) {
+  bilinearResizeWith(source, plan, RowRange{.count = plan.rows.low.size()}, output);
+}
+
+void bilinearResize(std::span<uint16_t const> const source, BilinearPlan const & plan,
+                    RowRange const rows, std::span<uint16_t> const output) {
+  bilinearResizeWith(source, plan, rows, output);
+}
+
+size_t nextMarkedPixel(Planes8 const & planes, ColorMarks const & marks, size_t from) {
+#if SIMDKERNELS_X86
+  // SSE2 has no gather, so it shares the scalar loop
+  if (active == SimdLevel::avx512) {
+    from = markedAvx512(planes, marks, from);
+  } else if (active == SimdLevel::avx2) {
+    from = markedAvx2(planes, marks, from);
+  }
+#endif
+  for (; from < planes.red.size(); ++from) {
+    if (marks.marked(planes.red[from], planes.green[from], planes.blue[from])) { return from; }
+  }
+  return from;
+}
+
+// NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
@@ -0,0 +1,132 @@
+#ifndef SIMDKERNELS_HPP
+#define SIMDKERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <sys/types.h>
+#include <vector>
+
+// Channel-wise kernels for the SOA image classes. Every kernel has SSE2, AVX2 and AVX-512
+// versions picked at runtime from the CPU features, plus a scalar version; all of them give the
+// same results.
+
+// Instruction sets the kernels can run on, in increasing order
+enum class SimdLevel : uint8_t { scalar, sse2, avx2, avx512 };
+
+// Best level this CPU supports, detected once at startup
+SimdLevel detectedSimdLevel();
+
+// Level the kernels run on; starts as detectedSimdLevel()
+SimdLevel activeSimdLevel();
+
+// Run the kernels on level, capped to detectedSimdLevel() (tests and benchmarks). Returns the
+// level actually selected.
+SimdLevel selectSimdLevel(SimdLevel level);
+
+struct LevelScale {
+    uint currentMax = 0;
+    uint newMax     = 0;
+};
+
+// maxlevel: output[i] = floor(float(input[i]) * float(newMax) / float(currentMax)), the rounding
+// of ImageSOA maxLevel. input and output may be the same channel.
+void scaleSamples(std::span<uint8_t const> input, std::span<uint8_t> output, LevelScale scale);
+void scaleSamples(std::span<uint8_t const> input, std::span<uint16_t> output, LevelScale scale);
+void scaleSamples(std::span<uint16_t const> input, std::span<uint16_t> output, LevelScale scale);
+void scaleSamples(std::span<uint16_t const> input, std::span<uint8_t> output, LevelScale scale);
+
+// Index of the first sample where |first[i] - second[i]| >= limit, or first.size() if none
+size_t firstDifference(std::span<uint8_t const> first, std::span<uint8_t const> second,
+                       uint limit);
+size_t firstDifference(std::span<uint16_t const> first, std::span<uint16_t const> second,
+                       uint limit);
+
+// Set of 8-bit RGB colors as a bitmap with one bit per color (2 MiB)
+class ColorMarks {
+  public:
+    ColorMarks();
+
+    void mark(uint8_t red, uint8_t green, uint8_t blue);
+
+    [[nodiscard]] bool marked(uint8_t red, uint8_t green, uint8_t blue) const;
+
+    [[nodiscard]] std::span<uint32_t const> words() const { return bits; }
+
+  private:
+    std::vector<uint32_t> bits;
+};
+
+struct Planes8 {
+    std::span<uint8_t const> red;
+    std::span<uint8_t const> green;
+    std::span<uint8_t const> blue;
+};
+
+// Index of the first pixel at or after from whose color is in marks, or planes.red.size()
+size_t nextMarkedPixel(Planes8 const & planes, ColorMarks const & marks, size_t from);
+
+// Fixed-point bilinear resize, done as a horizontal pass per source row (blendRow) and a
+// vertical pass per output row (blendRows). Weights are fractions of 1 << bilinearWeightBits
+// and all arithmetic fits in 32-bit lanes.
+//
+// Deviation from rounding the double bilinear value: 8-bit rows keep 8 fractional bits between
+// the passes and are off by at most 1. 16-bit rows are rounded to whole samples between the
+// passes and are off by at most 2 (at most 1 while samples stay below 256).
+constexpr uint bilinearWeightBits = 16;
+
+// Output i of a pass blends row[low[i]] and row[high[i]], with weight[i] on the second one
+struct BilinearTaps {
+    std::vector<uint32_t> low;
+    std::vector<uint32_t> high;
+    std::vector<uint32_t> weight;
+};
+
+// Weight in [0, 1] as a fixed-point fraction
+uint32_t bilinearWeight(double weight);
+
+// Horizontal pass: blended[i] for every tap, 8-bit rows with 8 fractional bits
+void blendRow(std::span<uint8_t const> row, BilinearTaps const & taps,
+              std::span<uint32_t> blended);
+void blendRow(std::span<uint16_t const> row, BilinearTaps const & taps,
+              std::span<uint32_t> blended);
+
+// Two blendRow results and the weight of bottom
+struct BlendedRows {
+    std::span<uint32_t const> top;
+    std::span<uint32_t const> bottom;
+    uint32_t weight = 0;
+};
+
+// Vertical pass: the rounded output samples
+void blendRows(BlendedRows const & rows, std::span<uint8_t> output);
+void blendRows(BlendedRows const & rows, std::span<uint16_t> output);
+
+// Taps along a row (columns), the source rows of every output row (rows) and the samples per
+// source row
+struct BilinearPlan {
+    BilinearTaps columns;
+    BilinearTaps rows;
+    size_t rowLength = 0;
+};
+
+// Both passes over a whole image, output row by output row. The two most recent blended source
+// rows are kept, so output rows sharing a source row blend it once.
+void bilinearResize(std::span<uint8_t const> source, BilinearPlan const & plan,
+                    std::span<uint8_t> output);
+void bilinearResize(std::span<uint16_t const> source, BilinearPlan const & plan,
+                    std::span<uint16_t> output);
+
+// Output rows [first, first + count) of an image
+struct RowRange {
+    size_t first = 0;
+    size_t count = 0;
+};
+
+// Only the given rows of the output image, so bands of one resize can run on different threads
+void bilinearResize(std::span<uint8_t const> source, BilinearPlan const & plan, RowRange rows,
+                    std::span<uint8_t> output);
+void bilinearResize(std::span<uint16_t const> source, BilinearPlan const & plan, RowRange rows,
+                    std::span<uint16_t> output);
+
+#endif //SIMDKERNELS_HPP
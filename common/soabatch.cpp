@@ -0,0 +1,52 @@
+#include "soabatch.hpp"
+
+#include "imtool_soa_aux.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+  constexpr char commentMarker = '#';
+} // namespace
+
+std::vector<BatchJob> readManifest(std::string const & path) {
+  std::ifstream manifest(path);
+  if (!manifest.is_open()) { throw std::runtime_error("Failed to open the file: " + path); }
+  std::vector<BatchJob> jobs;
+  size_t lineNumber = 0;
+  for (std::string line; std::getline(manifest, line);) {
+    ++lineNumber;
+    std::istringstream tokens(line);
+    BatchJob job{.line = lineNumber, .arguments = {"imtool-soa"}};
+    for (std::string token; tokens >> token;) { job.arguments.push_back(token); }
+    if (job.arguments.size() == 1 || job.arguments[1].front() == commentMarker) { continue; }
+    jobs.push_back(std::move(job));
+  }
+  return jobs;
+}
+
+std::vector<BatchResult> runBatch(std::vector<BatchJob> const & jobs, ThreadPool & pool) {
+  std::vector<BatchResult> results(jobs.size());
+  pool.parallelFor(jobs.size(), [&jobs, &results](size_t const index) {
+    BatchJob const & job = jobs[index];
+    auto const start     = std::chrono::steady_clock::now();
+    if (job.arguments.size() > 2 && job.arguments[2] == "batch") {
+      std::cerr << "Error: Nested batch manifests are not supported (line " << job.line << ")\n";
+      results[index].status = -1;
+    } else if (std::ranges::find(job.arguments, "--threads") != job.arguments.end()) {
+      // The jobs run on the shared pool, which only the batch command itself can size
+      std::cerr << "Error: --threads applies to the whole batch (line " << job.line << ")\n";
+      results[index].status = -1;
+    } else {
+      results[index].status = runCommand(job.arguments);
+    }
+    std::chrono::duration<double, std::milli> const elapsed =
+      std::chrono::steady_clock::now() - start;
+    results[index].milliseconds = elapsed.count();
+  });
+  return results;
+}
@@ -0,0 +1,30 @@
+#ifndef SOABATCH_HPP
+#define SOABATCH_HPP
+
+#include "threadpool.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// One manifest line, split into the argv imtool-soa would receive for it (program name first)
+struct BatchJob {
+    size_t line = 0;
+    std::vector<std::string> arguments;
+};
+
+struct BatchResult {
+    int status          = 0;
+    double milliseconds = 0;
+};
+
+// Manifest lines hold the usual command line arguments separated by whitespace:
+//   <input> <output> <operation> [args...]   or   <input> info
+// Blank lines and lines starting with '#' are skipped.
+std::vector<BatchJob> readManifest(std::string const & path);
+
+// Run every job through runCommand on the pool. Results keep the order of jobs. Each worker keeps
+// reusing its own channel buffers from one job to the next.
+std::vector<BatchResult> runBatch(std::vector<BatchJob> const & jobs, ThreadPool & pool);
+
+#endif //SOABATCH_HPP
@@ -0,0 +1,106 @@
+#include "threadpool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace {
+  std::mutex sharedLock;
+  size_t sharedThreads = 0;
+  std::unique_ptr<ThreadPool> sharedPool;
+} // namespace
+
+size_t defaultThreadCount() {
+  return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+ThreadPool::ThreadPool(size_t const threads) {
+  size_t const count = std::max<size_t>(1, threads);
+  workers.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    workers.emplace_back([this] { work(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard const guard(lock);
+    stopping = true;
+  }
+  wakeup.notify_all();
+  for (std::thread & worker : workers) { worker.join(); }
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+  {
+    std::lock_guard const guard(lock);
+    tasks.push(std::move(task));
+  }
+  wakeup.notify_one();
+}
+
+void ThreadPool::work() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock guard(lock);
+      wakeup.wait(guard, [this] { return stopping || !tasks.empty(); });
+      if (tasks.empty()) { return; }
+      task = std::move(tasks.front());
+      tasks.pop();
+    }
+    task();
+  }
+}
+
+void ThreadPool::parallelFor(size_t const count, std::function<void(size_t)> const & body) {
+  if (count == 0) { return; }
+  // Shared with the helpers: one may only start after the loop is over and must not touch the
+  // caller's stack then
+  struct Loop {
+      std::function<void(size_t)> body;
+      size_t count = 0;
+      std::atomic<size_t> next{0};
+      std::mutex doneLock;
+      std::condition_variable allDone;
+      size_t done = 0;
+      std::exception_ptr failure;
+  };
+  auto const loop = std::make_shared<Loop>();
+  loop->body      = body;
+  loop->count     = count;
+  auto const drain = [loop] {
+    for (size_t i = loop->next++; i < loop->count; i = loop->next++) {
+      std::exception_ptr failure;
+      try {
+        loop->body(i);
+      } catch (...) { failure = std::current_exception(); }
+      std::lock_guard const guard(loop->doneLock);
+      if (failure && !loop->failure) { loop->failure = failure; }
+      if (++loop->done == loop->count) { loop->allDone.notify_all(); }
+    }
+  };
+
+  // The caller drains too, so a call made from inside a worker still finishes when every other
+  // worker is busy
+  for (size_t i = 0; i < std::min(size() - 1, count - 1); ++i) { enqueue(drain); }
+  drain();
+  std::unique_lock guard(loop->doneLock);
+  loop->allDone.wait(guard, [&loop] { return loop->done == loop->count; });
+  if (loop->failure) { std::rethrow_exception(loop->failure); }
+}
+
+void setSharedThreadCount(size_t const threads) {
+  std::lock_guard const guard(sharedLock);
+  sharedThreads = threads;
+  sharedPool.reset();
+}
+
+ThreadPool & sharedThreadPool() {
+  std::lock_guard const guard(sharedLock);
+  if (!sharedPool) {
+    sharedPool = std::make_unique<ThreadPool>(sharedThreads == 0 ? defaultThreadCount()
+                                                                  : sharedThreads);
+  }
+  return *sharedPool;
+}
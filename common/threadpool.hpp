@@ -0,0 +1,100 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Number of workers used when the caller does not ask for a specific count
+size_t defaultThreadCount();
+
+// Fixed set of worker threads fed from a single FIFO queue. Tasks are started in submission
+// order; the destructor finishes every queued task before joining the workers.
+class ThreadPool {
+  public:
+    explicit ThreadPool(size_t threads = defaultThreadCount());
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool const &)             = delete;
+    ThreadPool & operator=(ThreadPool const &) = delete;
+    ThreadPool(ThreadPool &&)                  = delete;
+    ThreadPool & operator=(ThreadPool &&)      = delete;
+
+    [[nodiscard]] size_t size() const { return workers.size(); }
+
+    // Queue a task; exceptions it throws are rethrown by the returned future
+    template <typename Task>
+    auto submit(Task && task) -> std::future<std::invoke_result_t<std::decay_t<Task>>> {
+      using Result  = std::invoke_result_t<std::decay_t<Task>>;
+      auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<Task>(task));
+      std::future<Result> result = packaged->get_future();
+      enqueue([packaged] { (*packaged)(); });
+      return result;
+    }
+
+    // Run body(i) for every i in [0, count) and wait for all of them. Indices are handed out one
+    // at a time to whichever thread is free, so uneven items balance out. The caller counts as one
+    // of the size() threads, so a one-thread pool runs body serially on the caller. The first
+    // exception thrown by body is rethrown once every index has been processed.
+    void parallelFor(size_t count, std::function<void(size_t)> const & body);
+
+  private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex lock;
+    std::condition_variable wakeup;
+    bool stopping = false;
+
+    void enqueue(std::function<void()> task);
+    void work();
+};
+
+// Rows of an image, or of each of its channels, to be processed in bands
+struct RowBands {
+    size_t width    = 0;
+    size_t height   = 0;
+    size_t channels = 1;
+    // Samples per band below which splitting further is not worth a task
+    size_t minSamples = 1;
+    // Band heights are a multiple of this (tile rows), except the last band's
+    size_t rowAlign = 1;
+};
+
+// Bands per pool thread, so one slow thread only holds back a small share of the work
+constexpr size_t bandsPerThread = 4;
+
+// Call body(channel, firstRow, endRow) for bands of rows of every channel. parallelFor hands the
+// bands out one at a time, so a thread that finishes early takes the next one from the shared
+// index and uneven bands balance out. Band bounds depend only on the shape and the pool size.
+template <typename Body>
+void forEachRowBand(ThreadPool & pool, RowBands const & shape, Body const & body) {
+  if (shape.width == 0 || shape.height == 0 || shape.channels == 0) { return; }
+  size_t const wanted         = pool.size() * bandsPerThread;
+  size_t const rowsForThreads = (shape.height + wanted - 1) / wanted;
+  size_t const rowsForSize    = (shape.minSamples + shape.width - 1) / shape.width;
+  size_t rows                 = std::max(rowsForThreads, rowsForSize);
+  rows                        = ((rows + shape.rowAlign - 1) / shape.rowAlign) * shape.rowAlign;
+  size_t const bands          = (shape.height + rows - 1) / rows;
+  pool.parallelFor(shape.channels * bands, [&](size_t const task) {
+    size_t const band = task % bands;
+    body(task / bands, band * rows, std::min(shape.height, (band + 1) * rows));
+  });
+}
+
+// Thread count of the pool shared by the image operations; 0 means defaultThreadCount(). Replaces
+// the current shared pool, so it must not be called while that pool is running work.
+void setSharedThreadCount(size_t threads);
+
+// Pool shared by the image operations and batch mode, created on first use
+ThreadPool & sharedThreadPool();
+
+#endif //THREADPOOL_HPP
@@ -1,67 +1,206 @@
 #include "imageaos.hpp"
 
+#include "common/colorhistogram.hpp"
+#include "common/colortree.hpp"
+#include "common/palette.hpp"
+#include "common/ratioresize.hpp"
+#include "common/resample.hpp"
+#include "common/simdkernels.hpp"
+#include "common/threadpool.hpp"
+
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <span>
 #include <stdexcept>
+#include <type_traits>
 #include <unordered_map>
 
-void scaleIntensity(std::vector<Pixel>& pixels, int currentMax, int newMax) {
+namespace {
+  // Tabla con el resultado de cada valor posible de una muestra de tipo In, calculado como antes
+  // por muestra
+  template <typename In>
+  std::vector<uint16_t> intensityTable(int currentMax, int newMax) {
+    std::vector<uint16_t> table(size_t{std::numeric_limits<In>::max()} + 1);
+    for (size_t value = 0; value < table.size(); ++value) {
+      table[value] = static_cast<uint16_t>(static_cast<double>(static_cast<int64_t>(value) * newMax) / static_cast<double>(currentMax));
+    }
+    return table;
+  }
+}
+
+template <typename P>
+void scaleIntensity(std::vector<P>& pixels, int currentMax, int newMax) {
+  using Sample = typename P::Sample;
+  const std::vector<uint16_t> table = intensityTable<Sample>(currentMax, newMax);
   for (auto& pixel : pixels) {
-    pixel.red = static_cast<uint16_t>(std::trunc(pixel.red * newMax) / static_cast<double>(currentMax));
-    pixel.green = static_cast<uint16_t>(std::trunc(pixel.green * newMax )/ static_cast<double>(currentMax));
-    pixel.blue = static_cast<uint16_t>(std::trunc(pixel.blue * newMax) / static_cast<double>(currentMax));
+    pixel.red = static_cast<Sample>(table[pixel.red]);
+    pixel.green = static_cast<Sample>(table[pixel.green]);
+    pixel.blue = static_cast<Sample>(table[pixel.blue]);
   }
 }
 
+template <typename Out, typename In>
+std::vector<Out> scaleIntensityTo(const std::vector<In>& pixels, int currentMax, int newMax) {
+  using Sample = typename Out::Sample;
+  const std::vector<uint16_t> table = intensityTable<typename In::Sample>(currentMax, newMax);
+  std::vector<Out> scaled(pixels.size());
+  for (size_t i = 0; i < pixels.size(); ++i) {
+    scaled[i] = Out{.red = static_cast<Sample>(table[pixels[i].red]),
+                    .green = static_cast<Sample>(table[pixels[i].green]),
+                    .blue = static_cast<Sample>(table[pixels[i].blue])};
+  }
+  return scaled;
+}
+
 // Función para interpolar un solo canal de color entre dos valores
 double interpolateChannel(double channel1, double channel2, double weight) {
     return channel1 + (weight * (channel2 - channel1));
 }
 
 // Interpolación de un píxel usando double para mayor precisión
-Pixel interpolate(const Pixel& pixel1, const Pixel& pixel2, double weight) {
-    Pixel result = {.red = 0, .green = 0, .blue = 0};
-    result.red = static_cast<uint16_t>(std::round(interpolateChannel(static_cast<double>(pixel1.red), static_cast<double>(pixel2.red), weight)));
-    result.green = static_cast<uint16_t>(std::round(interpolateChannel(static_cast<double>(pixel1.green), static_cast<double>(pixel2.green), weight)));
-    result.blue = static_cast<uint16_t>(std::round(interpolateChannel(static_cast<double>(pixel1.blue), static_cast<double>(pixel2.blue), weight)));
+template <typename P>
+P interpolate(const P& pixel1, const P& pixel2, double weight) {
+    using Sample = typename P::Sample;
+    P result = {.red = 0, .green = 0, .blue = 0};
+    result.red = static_cast<Sample>(std::round(interpolateChannel(static_cast<double>(pixel1.red), static_cast<double>(pixel2.red), weight)));
+    result.green = static_cast<Sample>(std::round(interpolateChannel(static_cast<double>(pixel1.green), static_cast<double>(pixel2.green), weight)));
+    result.blue = static_cast<Sample>(std::round(interpolateChannel(static_cast<double>(pixel1.blue), static_cast<double>(pixel2.blue), weight)));
     return result;
 }
 
+namespace {
+  // Píxeles de salida por banda por debajo de los cuales no compensa crear otra tarea
+  constexpr size_t minPixelesPorBanda = size_t{1} << 14U;
+
+  // Un píxel son tres muestras seguidas, así que una fila se trata como un solo canal
+  static_assert(sizeof(Pixel8) == 3 * sizeof(uint8_t) && sizeof(Pixel16) == 3 * sizeof(uint16_t));
+  constexpr size_t canales = 3;
+}
+
 // Implementación de la función para redimensionar la imagen con ajustes
 // Implementación de la función para redimensionar la imagen con ajustes
-std::vector<Pixel> resizeImage(const std::vector<Pixel>& originalPixels, const PPMMetadata& originalMetadata, int newWidth, int newHeight) {
-    std::vector<Pixel> resizedPixels(static_cast<size_t>(newWidth) * static_cast<size_t>(newHeight));
+template <typename P>
+std::vector<P> resizeImage(const std::vector<P>& originalPixels, const PPMMetadata& originalMetadata, int newWidth, int newHeight) {
+    std::vector<P> resizedPixels(static_cast<size_t>(newWidth) * static_cast<size_t>(newHeight));
 
     const double xRatio = static_cast<double>(originalMetadata.width - 1) / static_cast<double>(newWidth - 1);
     const double yRatio = static_cast<double>(originalMetadata.height - 1) / static_cast<double>(newHeight -1);
 
-    for (int yPrime = 0; yPrime < newHeight; ++yPrime) {
-        for (int xPrime = 0; xPrime < newWidth; ++xPrime) {
-            const double normalizedX = xPrime * xRatio;
-            const double normalizedY = yPrime * yRatio;
-
-            auto lowerX = static_cast<size_t>(std::floor(normalizedX));
-            const size_t upperX = std::min(lowerX + 1, static_cast<size_t>(originalMetadata.width - 1));
-            auto lowerY = static_cast<size_t>(std::floor(normalizedY));
-            const size_t upperY = std::min(lowerY + 1, static_cast<size_t>(originalMetadata.height - 1));
-
-            const Pixel& pixel1 = originalPixels[(lowerY * static_cast<size_t>(originalMetadata.width)) + lowerX];
-            const Pixel& pixel2 = originalPixels[(lowerY * static_cast<size_t>(originalMetadata.width)) + upperX];
-            const Pixel& pixel3 = originalPixels[(upperY * static_cast<size_t>(originalMetadata.width)) + lowerX];
-            const Pixel& pixel4 = originalPixels[(upperY * static_cast<size_t>(originalMetadata.width)) + upperX];
+    // Bandas de filas de salida repartidas entre los hilos del pool compartido
+    const RowBands bandas = {.width = static_cast<size_t>(newWidth), .height = static_cast<size_t>(newHeight), .minSamples = minPixelesPorBanda};
+
+    // Con pasos de 4, 2, 1, 1/2 o 1/4 píxeles en ambos ejes el mismo resultado sale de sumas y desplazamientos
+    const auto columnas = ratioAxis(xRatio, static_cast<size_t>(originalMetadata.width), static_cast<size_t>(newWidth));
+    const auto filas = ratioAxis(yRatio, static_cast<size_t>(originalMetadata.height), static_cast<size_t>(newHeight));
+    if (columnas && filas) {
+        using Sample = typename P::Sample;
+        const RatioPlan plan = {.columns = *columnas, .rows = *filas, .channels = canales, .rounding = RatioRounding::perPass};
+        // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+        const std::span<const Sample> source(reinterpret_cast<const Sample*>(originalPixels.data()), originalPixels.size() * canales);
+        const std::span<Sample> output(reinterpret_cast<Sample*>(resizedPixels.data()), resizedPixels.size() * canales);
+        // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+        forEachRowBand(sharedThreadPool(), bandas, [&](size_t, size_t primera, size_t fin) {
+            ratioResize(source, plan, RowRange{.first = primera, .count = fin - primera}, output);
+        });
+        return resizedPixels;
+    }
+    forEachRowBand(sharedThreadPool(), bandas, [&](size_t, size_t primera, size_t fin) {
+        for (int yPrime = static_cast<int>(primera); yPrime < static_cast<int>(fin); ++yPrime) {
+            for (int xPrime = 0; xPrime < newWidth; ++xPrime) {
+                const double normalizedX = xPrime * xRatio;
+                const double normalizedY = yPrime * yRatio;
+
+                auto lowerX = static_cast<size_t>(std::floor(normalizedX));
+                const size_t upperX = std::min(lowerX + 1, static_cast<size_t>(originalMetadata.width - 1));
+                auto lowerY = static_cast<size_t>(std::floor(normalizedY));
+                const size_t upperY = std::min(lowerY + 1, static_cast<size_t>(originalMetadata.height - 1));
+
+                const P& pixel1 = originalPixels[(lowerY * static_cast<size_t>(originalMetadata.width)) + lowerX];
+                const P& pixel2 = originalPixels[(lowerY * static_cast<size_t>(originalMetadata.width)) + upperX];
+                const P& pixel3 = originalPixels[(upperY * static_cast<size_t>(originalMetadata.width)) + lowerX];
+                const P& pixel4 = originalPixels[(upperY * static_cast<size_t>(originalMetadata.width)) + upperX];
+
+                const double xWeight = normalizedX - static_cast<double>(lowerX);
+                const double yWeight = normalizedY - static_cast<double>(lowerY);
+
+                const P color1 = interpolate(pixel1, pixel2, xWeight);
+                const P color2 = interpolate(pixel3, pixel4, xWeight);
+                const P finalColor = interpolate(color1, color2, yWeight);
+
+                resizedPixels[(static_cast<size_t>(yPrime) * static_cast<size_t>(newWidth)) + static_cast<size_t>(xPrime)] = finalColor;
+            }
+        }
+    });
+    return resizedPixels;
+}
 
-            const double xWeight = normalizedX - static_cast<double>(lowerX);
-            const double yWeight = normalizedY - static_cast<double>(lowerY);
+namespace {
+  // Índices y pesos de resizeImage para cada posición de salida: inferior, superior y peso
+  BilinearTaps tapsResize(size_t salidas, size_t origen, double ratio, size_t canalesPorPosicion) {
+    BilinearTaps taps;
+    for (size_t posicion = 0; posicion < salidas; ++posicion) {
+      const double normalizado = static_cast<double>(posicion) * ratio;
+      const auto inferior = static_cast<size_t>(std::floor(normalizado));
+      const size_t superior = std::min(inferior + 1, origen - 1);
+      for (size_t canal = 0; canal < canalesPorPosicion; ++canal) {
+        taps.low.push_back(static_cast<uint32_t>((inferior * canalesPorPosicion) + canal));
+        taps.high.push_back(static_cast<uint32_t>((superior * canalesPorPosicion) + canal));
+        taps.weight.push_back(bilinearWeight(normalizado - static_cast<double>(inferior)));
+      }
+    }
+    return taps;
+  }
+}
 
-            const Pixel color1 = interpolate(pixel1, pixel2, xWeight);
-            const Pixel color2 = interpolate(pixel3, pixel4, xWeight);
-            const Pixel finalColor = interpolate(color1, color2, yWeight);
+// Mismos índices y pesos que resizeImage; como ella, redondea tras la pasada horizontal
+template <typename P>
+std::vector<P> resizeImageFixed(const std::vector<P>& originalPixels, const PPMMetadata& originalMetadata, int newWidth, int newHeight) {
+    using Sample = typename P::Sample;
+    std::vector<P> resizedPixels(static_cast<size_t>(newWidth) * static_cast<size_t>(newHeight));
+    const auto width = static_cast<size_t>(originalMetadata.width);
+    const auto height = static_cast<size_t>(originalMetadata.height);
+    const double xRatio = static_cast<double>(originalMetadata.width - 1) / static_cast<double>(newWidth - 1);
+    const double yRatio = static_cast<double>(originalMetadata.height - 1) / static_cast<double>(newHeight -1);
+    const BilinearPlan plan = {.columns = tapsResize(static_cast<size_t>(newWidth), width, xRatio, canales),
+                               .rows = tapsResize(static_cast<size_t>(newHeight), height, yRatio, 1),
+                               .rowLength = width * canales};
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+    const std::span<const Sample> source(reinterpret_cast<const Sample*>(originalPixels.data()), originalPixels.size() * canales);
+    const std::span<Sample> output(reinterpret_cast<Sample*>(resizedPixels.data()), resizedPixels.size() * canales);
+    // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+    const RowBands bandas = {.width = static_cast<size_t>(newWidth), .height = static_cast<size_t>(newHeight), .minSamples = minPixelesPorBanda};
+    forEachRowBand(sharedThreadPool(), bandas, [&](size_t, size_t primera, size_t fin) {
+        bilinearResize(source, plan, RowRange{.first = primera, .count = fin - primera}, output);
+    });
+    return resizedPixels;
+}
 
-            resizedPixels[(static_cast<size_t>(yPrime) * static_cast<size_t>(newWidth)) + static_cast<size_t>(xPrime)] = finalColor;
-        }
-    }
+// Los núcleos se calculan una vez; las tres muestras de cada píxel se filtran juntas
+template <typename P>
+std::vector<P> resampleImage(const std::vector<P>& originalPixels, const PPMMetadata& originalMetadata, const PPMMetadata& newMetadata, ResizeFilter filter) {
+    using Sample = typename P::Sample;
+    const auto newWidth = static_cast<size_t>(newMetadata.width);
+    const auto newHeight = static_cast<size_t>(newMetadata.height);
+    std::vector<P> resizedPixels(newWidth * newHeight);
+    const auto width = static_cast<size_t>(originalMetadata.width);
+    const ResamplePlan plan = {.columns = resampleKernels(filter, newWidth, width),
+                               .rows = resampleKernels(filter, newHeight, static_cast<size_t>(originalMetadata.height)),
+                               .rowLength = width,
+                               .channels = canales,
+                               .maxValue = static_cast<uint>(originalMetadata.maxColorValue)};
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+    const std::span<const Sample> source(reinterpret_cast<const Sample*>(originalPixels.data()), originalPixels.size() * canales);
+    const std::span<Sample> output(reinterpret_cast<Sample*>(resizedPixels.data()), resizedPixels.size() * canales);
+    // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+    const RowBands bandas = {.width = newWidth, .height = newHeight, .minSamples = minPixelesPorBanda};
+    forEachRowBand(sharedThreadPool(), bandas, [&](size_t, size_t primera, size_t fin) {
+        resample(source, plan, RowRange{.first = primera, .count = fin - primera}, output);
+    });
     return resizedPixels;
 }
 
@@ -69,8 +208,8 @@ std::vector<Pixel> resizeImage(const std::vector<Pixel>& originalPixels, const P
 
 // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
 // Implementación de la función para guardar la imagen
-// Implementación de la función para guardar la imagen
-void saveImage(const std::string& filename, const std::vector<Pixel>& pixels, const PPMMetadata& metadata) {
+template <typename P>
+void saveImage(const std::string& filename, const std::vector<P>& pixels, const PPMMetadata& metadata) {
   std::ofstream file(filename, std::ios::binary);
   if (!file.is_open()) {
     throw std::runtime_error("Unable to open file: " + filename);
@@ -82,137 +221,179 @@ void saveImage(const std::string& filename, const std::vector<Pixel>& pixels, co
 
   for (const auto& pixel : pixels) {
     if (bytesPerChannel == 1) {
-      auto red = static_cast<unsigned char>(pixel.red);
-      auto green = static_cast<unsigned char>(pixel.green);
-      auto blue = static_cast<unsigned char>(pixel.blue);
-
-      file.write(reinterpret_cast<char*>(&red), 1);
-      file.write(reinterpret_cast<char*>(&green), 1);
-      file.write(reinterpret_cast<char*>(&blue), 1);
+      std::array<unsigned char, 3> const bytes = {static_cast<unsigned char>(pixel.red),
+                                                  static_cast<unsigned char>(pixel.green),
+                                                  static_cast<unsigned char>(pixel.blue)};
+      file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
     } else {
-      auto red = static_cast<unsigned short>(pixel.red);
-      auto green = static_cast<unsigned short>(pixel.green);
-      auto blue = static_cast<unsigned short>(pixel.blue);
-
-      file.write(reinterpret_cast<char*>(&red), 2);
-      file.write(reinterpret_cast<char*>(&green), 2);
-      file.write(reinterpret_cast<char*>(&blue), 2);
+      // Big-endian, el orden de las muestras de 16 bits en un PPM
+      std::array<unsigned char, 6> bytes{};
+      const std::array<unsigned, 3> samples = {pixel.red, pixel.green, pixel.blue};
+      for (size_t i = 0; i < samples.size(); ++i) {
+        bytes[2 * i] = static_cast<unsigned char>(samples[i] >> ocho);
+        bytes[(2 * i) + 1] = static_cast<unsigned char>(samples[i] & 0xFFU);
+      }
+      file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
     }
   }
 
   file.close();
 }
 
+namespace {
+  // Decodifica el payload ya mapeado en un vector de píxeles. Las muestras de 16 bits se leen en
+  // big-endian y solo caben en Pixel16.
+  template <typename P>
+  std::vector<P> decodePixels(std::span<const uint8_t> payload, const PPMMetadata& metadata) {
+    using Sample = typename P::Sample;
+    std::vector<P> pixels(static_cast<size_t>(metadata.width) * static_cast<size_t>(metadata.height));
+
+    constexpr int maxValue = 256;
+    const size_t bytesPerChannel = (metadata.maxColorValue < maxValue) ? 1 : 2;
+    if (bytesPerChannel > sizeof(Sample)) {
+      throw std::runtime_error("Una imagen de 16 bits necesita píxeles de 16 bits");
+    }
+    if (payload.size() < pixels.size() * 3 * bytesPerChannel) {
+      throw std::runtime_error("Unable to read pixel data");
+    }
 
-
-
-// Implementación de la función para cargar la imagen
-// Implementación de la función para cargar la imagen
-std::vector<Pixel> loadImage(const std::string& filename, const PPMMetadata& metadata) {
-  std::ifstream file(filename, std::ios::binary);
-  if (!file.is_open()) {throw std::runtime_error("Unable to open file: " + filename);}
-
-  std::string magicNumber;
-  file >> magicNumber;
-  file.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Ignora la línea completa después del magicNumber
-  PPMMetadata mdata;
-  file >> mdata.width >> mdata.height >> mdata.maxColorValue;
-  file.ignore(1, '\n');
-  std::vector<Pixel> pixels(static_cast<std::vector<Pixel>::size_type>(metadata.width) * static_cast<std::vector<Pixel>::size_type>(metadata.height));
-
-  constexpr int maxValue = 256;
-  const int bytesPerChannel = (metadata.maxColorValue < maxValue) ? 1 : 2;
-
-  for (auto& pixel : pixels) {
-    if (bytesPerChannel == 1) {
-      unsigned char red = 0;
-      unsigned char green = 0;
-      unsigned char blue = 0;
-      file.read(reinterpret_cast<char*>(&red), 1);
-      file.read(reinterpret_cast<char*>(&green), 1);
-      file.read(reinterpret_cast<char*>(&blue), 1);
-      pixel.red = red;
-      pixel.green = green;
-      pixel.blue = blue;
-    } else {
-      unsigned short red = 0;
-      unsigned short green = 0;
-      unsigned short blue = 0;
-      file.read(reinterpret_cast<char*>(&red), 2);
-      file.read(reinterpret_cast<char*>(&green), 2);
-      file.read(reinterpret_cast<char*>(&blue), 2);
-      pixel.red = static_cast<uint8_t>(red);
-      pixel.green = static_cast<uint8_t>(green);
-      pixel.blue = static_cast<uint8_t>(blue);
+    const uint8_t* sample = payload.data();
+    for (auto& pixel : pixels) {
+      if (bytesPerChannel == 1) {
+        pixel.red = sample[0];
+        pixel.green = sample[1];
+        pixel.blue = sample[2];
+        sample += 3;
+      } else {
+        pixel.red = static_cast<Sample>((sample[0] << ocho) | sample[1]);
+        pixel.green = static_cast<Sample>((sample[2] << ocho) | sample[3]);
+        pixel.blue = static_cast<Sample>((sample[4] << ocho) | sample[5]);
+        sample += 6;
+      }
     }
+    return pixels;
   }
-  file.close();
-  return pixels;
 }
 
+// Implementación de la función para cargar la imagen
+template <typename P>
+std::vector<P> loadImage(const std::string& filename, const PPMMetadata& metadata) {
+  const PPMFile file(filename);
+  return decodePixels<P>(file.payload(), metadata);
+}
+
+// Carga desde un archivo ya abierto: la cabecera se ha leído una sola vez
+template <typename P>
+std::vector<P> loadImage(const PPMFile& file) {
+  return decodePixels<P>(file.payload(), getPPMMetadata(file.header()));
+}
 
 // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
 
-
-// Función para obtener metadatos de PPM
-PPMMetadata getPPMMetadata(const std::string& filename) {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        throw std::runtime_error("Unable to open file: " + filename);
+// Carga desde el formato comprimido: cada bloque de índices se traduce con la tabla de colores
+template <typename P>
+std::vector<P> loadImage(const CompressedFile& file) {
+  using Sample = typename P::Sample;
+  if (file.format().maxColorValue > std::numeric_limits<Sample>::max()) {
+    throw std::runtime_error("Una imagen de 16 bits necesita píxeles de 16 bits");
+  }
+  std::vector<P> colors;
+  colors.reserve(file.colors().size());
+  for (const uint64_t key : file.colors()) {
+    colors.push_back(P{.red = static_cast<Sample>(keyRed(key)),
+                       .green = static_cast<Sample>(keyGreen(key)),
+                       .blue = static_cast<Sample>(keyBlue(key))});
+  }
+  std::vector<P> pixels(file.format().width * file.format().height);
+  file.forEachIndexChunk([&](size_t first, std::span<const uint32_t> indices) {
+    for (size_t i = 0; i < indices.size(); ++i) {
+      pixels[first + i] = colors[indices[i]];
     }
+  });
+  return pixels;
+}
 
-    PPMMetadata metadata;
-    file >> metadata.magicNumber;
-    file >> metadata.width >> metadata.height >> metadata.maxColorValue;
-    file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-    file.close();
+PPMMetadata getPPMMetadata(const CompressedFile& file) {
+  return {.magicNumber = "P6",
+          .width = static_cast<int>(file.format().width),
+          .height = static_cast<int>(file.format().height),
+          .maxColorValue = static_cast<int>(file.format().maxColorValue)};
+}
 
-    return metadata;
+// Implementación de la compresión: tabla de colores distintos más un índice por píxel
+template <typename P>
+void compressImage(const std::string& filename, const std::vector<P>& pixels, const PPMMetadata& metadata) {
+  const Palette palette = buildPalette(pixels.size(), [&pixels](size_t index) {
+    return colorKey(pixels[index].red, pixels[index].green, pixels[index].blue);
+  });
+  const CompressedFormat format = {.width = static_cast<size_t>(metadata.width),
+                                   .height = static_cast<size_t>(metadata.height),
+                                   .maxColorValue = static_cast<uint>(metadata.maxColorValue)};
+  saveCompressed(filename, format, palette);
 }
 
+
 // Función para calcular la distancia entre colores
 // Función para calcular la distancia entre colores
 // Function to calculate the distance between colors
-int colorDistance(const Pixel& pixel1, const Pixel& pixel2) {
+template <typename P>
+int colorDistance(const P& pixel1, const P& pixel2) {
   return ((pixel1.red - pixel2.red) * (pixel1.red - pixel2.red)) +
          ((pixel1.green - pixel2.green) * (pixel1.green - pixel2.green)) +
          ((pixel1.blue - pixel2.blue) * (pixel1.blue - pixel2.blue));
 }
 
-std::vector<Pixel> removeLeastFrequentColors(const std::vector<Pixel>& pixels, int n) {
+template <typename P>
+std::vector<P> removeLeastFrequentColors(const std::vector<P>& pixels, int n) {
   if (n < 0) {throw std::invalid_argument("El número de colores a eliminar no puede ser negativo.");}
 
   // Contar la frecuencia de colores
-  std::unordered_map<Pixel, int, PixelHash> colorFrequency;
-  for (const auto& pixel : pixels) {
-    colorFrequency[pixel]++;
+  std::unordered_map<P, int, PixelHash> colorFrequency;
+  if constexpr (std::is_same_v<P, Pixel8>) {
+    // Histograma denso de los 2^24 colores y una inserción por color en su primer píxel: las
+    // mismas inserciones en el mismo orden que contando píxel a píxel, así que el mapa se recorre
+    // igual y los empates de frecuencia y distancia se resuelven igual
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    const ColorHistogram histograma(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(pixels.data()), pixels.size() * canales));
+    histograma.forEachFirstPixel(
+        pixels.size(),
+        [&pixels](size_t i) { return ColorHistogram::indexOf(pixels[i].red, pixels[i].green, pixels[i].blue); },
+        [&](size_t i, uint64_t cuenta) { colorFrequency.emplace(pixels[i], static_cast<int>(cuenta)); });
+  } else {
+    for (const auto& pixel : pixels) {
+      colorFrequency[pixel]++;
+    }
   }
 
   // Convertir a vector y ordenar por frecuencia
-  std::vector<std::pair<Pixel, int>> colorFreqVec(colorFrequency.begin(), colorFrequency.end());
+  std::vector<std::pair<P, int>> colorFreqVec(colorFrequency.begin(), colorFrequency.end());
   std::ranges::sort(colorFreqVec, [](const auto& aaa, const auto& bbb) {
     return aaa.second < bbb.second;
   });
 
   // Mantener los colores más frecuentes
-  std::unordered_map<Pixel, Pixel, PixelHash> colorReplacement;
-  for (size_t i = 0; i < static_cast<size_t>(n) && i < colorFreqVec.size(); ++i) {
-    const Pixel& colorToRemove = colorFreqVec[i].first;
-    int minDistance = std::numeric_limits<int>::max();
-    Pixel closestColor = colorFreqVec[i].first;
+  const size_t eliminados = std::min(static_cast<size_t>(n), colorFreqVec.size());
+  std::unordered_map<P, P, PixelHash> colorReplacement;
+  if (eliminados < colorFreqVec.size()) {
+    // Árbol k-d sobre los colores que se quedan, en el orden de colorFreqVec: a igual distancia
+    // gana el primero, igual que al recorrerlos buscando solo colores estrictamente más cercanos
+    std::vector<ColorKey> claves;
+    claves.reserve(colorFreqVec.size() - eliminados);
+    for (size_t i = eliminados; i < colorFreqVec.size(); ++i) {
+      const P& color = colorFreqVec[i].first;
+      claves.push_back({color.red, color.green, color.blue});
+    }
+    const ColorTree arbol(claves);
 
     // Encontrar el color más cercano
-    for (auto it = colorFreqVec.begin() + n; it != colorFreqVec.end(); ++it) {
-      const int distance = colorDistance(colorToRemove, it->first);
-      if (distance < minDistance) {
-        minDistance = distance;
-        closestColor = it->first;
-      }
+    for (size_t i = 0; i < eliminados; ++i) {
+      const P& colorToRemove = colorFreqVec[i].first;
+      const size_t cercano = arbol.nearest({colorToRemove.red, colorToRemove.green, colorToRemove.blue});
+      colorReplacement[colorToRemove] = colorFreqVec[eliminados + cercano].first;
     }
-    colorReplacement[colorToRemove] = closestColor;
   }
   // Aplicar reemplazos
-  std::vector<Pixel> modifiedPixels = pixels;
+  std::vector<P> modifiedPixels = pixels;
   for (auto& pixel : modifiedPixels) {
     if (colorReplacement.contains(pixel)) {
       pixel = colorReplacement[pixel];
@@ -221,4 +402,32 @@ std::vector<Pixel> removeLeastFrequentColors(const std::vector<Pixel>& pixels, i
   return modifiedPixels;
 }
 
-
+// Instanciaciones para los dos tipos de píxel
+template void scaleIntensity(std::vector<Pixel8>& pixels, int currentMax, int newMax);
+template void scaleIntensity(std::vector<Pixel16>& pixels, int currentMax, int newMax);
+template std::vector<Pixel8> scaleIntensityTo(const std::vector<Pixel8>& pixels, int currentMax, int newMax);
+template std::vector<Pixel16> scaleIntensityTo(const std::vector<Pixel8>& pixels, int currentMax, int newMax);
+template std::vector<Pixel8> scaleIntensityTo(const std::vector<Pixel16>& pixels, int currentMax, int newMax);
+template std::vector<Pixel16> scaleIntensityTo(const std::vector<Pixel16>& pixels, int currentMax, int newMax);
+template std::vector<Pixel8> loadImage(const std::string& filename, const PPMMetadata& metadata);
+template std::vector<Pixel16> loadImage(const std::string& filename, const PPMMetadata& metadata);
+template std::vector<Pixel8> loadImage(const PPMFile& file);
+template std::vector<Pixel16> loadImage(const PPMFile& file);
+template std::vector<Pixel8> loadImage(const CompressedFile& file);
+template std::vector<Pixel16> loadImage(const CompressedFile& file);
+template void saveImage(const std::string& filename, const std::vector<Pixel8>& pixels, const PPMMetadata& metadata);
+template void saveImage(const std::string& filename, const std::vector<Pixel16>& pixels, const PPMMetadata& metadata);
+template void compressImage(const std::string& filename, const std::vector<Pixel8>& pixels, const PPMMetadata& metadata);
+template void compressImage(const std::string& filename, const std::vector<Pixel16>& pixels, const PPMMetadata& metadata);
+template std::vector<Pixel8> resizeImage(const std::vector<Pixel8>& originalPixels, const PPMMetadata& originalMetadata, int newWidth, int newHeight);
+template std::vector<Pixel16> resizeImage(const std::vector<Pixel16>& originalPixels, const PPMMetadata& originalMetadata, int newWidth, int newHeight);
+template std::vector<Pixel8> resizeImageFixed(const std::vector<Pixel8>& originalPixels, const PPMMetadata& originalMetadata, int newWidth, int newHeight);
+template std::vector<Pixel16> resizeImageFixed(const std::vector<Pixel16>& originalPixels, const PPMMetadata& originalMetadata, int newWidth, int newHeight);
+template std::vector<Pixel8> resampleImage(const std::vector<Pixel8>& originalPixels, const PPMMetadata& originalMetadata, const PPMMetadata& newMetadata, ResizeFilter filter);
+template std::vector<Pixel16> resampleImage(const std::vector<Pixel16>& originalPixels, const PPMMetadata& originalMetadata, const PPMMetadata& newMetadata, ResizeFilter filter);
+template std::vector<Pixel8> removeLeastFrequentColors(const std::vector<Pixel8>& pixels, int n);
+template std::vector<Pixel16> removeLeastFrequentColors(const std::vector<Pixel16>& pixels, int n);
+template int colorDistance(const Pixel8& pixel1, const Pixel8& pixel2);
+template int colorDistance(const Pixel16& pixel1, const Pixel16& pixel2);
+template Pixel8 interpolate(const Pixel8& pixel1, const Pixel8& pixel2, double weight);
+template Pixel16 interpolate(const Pixel16& pixel1, const Pixel16& pixel2, double weight);
@@ -1,67 +1,110 @@
 #ifndef IMAGEAOS_HPP
 #define IMAGEAOS_HPP
 
+#include "common/PPMMetadata.hpp"
+#include "common/palette.hpp"
+#include "common/resample.hpp"
+
 #include <cstdint>
 #include <string>
 #include <vector>
 
-// Definición de la estructura Pixel
-struct Pixel {
-  uint16_t red;
-  uint16_t green;
-  uint16_t blue;
+// Píxel con tres muestras de tipo S: Pixel8 ocupa 3 bytes y Pixel16 6, así que las imágenes de 8
+// bits no gastan el doble de memoria ni de ancho de banda
+template <typename S>
+struct BasicPixel {
+  using Sample = S;
+
+  S red;
+  S green;
+  S blue;
 
-  bool operator==(const Pixel& other) const {
+  bool operator==(const BasicPixel& other) const {
     return red == other.red && green == other.green && blue == other.blue;
   }
 };
 
+using Pixel8 = BasicPixel<uint8_t>;
+using Pixel16 = BasicPixel<uint16_t>;
+// Nombre histórico del píxel de 16 bits
+using Pixel = Pixel16;
+
 constexpr int ocho = 8;
 constexpr int dieceiseis = 16;
-// Hash function for Pixel
+// Hash function for Pixel; mismo valor para un color en Pixel8 y en Pixel16
 struct PixelHash {
-  std::size_t operator()(const Pixel& pixel) const {
+  template <typename P>
+  std::size_t operator()(const P& pixel) const {
     return (static_cast<std::size_t>(pixel.red) << dieceiseis) | (static_cast<std::size_t>(pixel.green) << ocho) | static_cast<std::size_t>(pixel.blue);
   }
 };
 
-// Definición de la estructura PPMMetadata
-struct PPMMetadata {
-  std::string magicNumber;
-  int width = 0;
-  int height = 0;
-  int maxColorValue = 0;
-};
-
 struct ImageMetadata {
   int width = 0;
   int height = 0;
   int maxColorValue = 0;
 };
 
-// Función que obtiene los metadatos de un archivo PPM
-PPMMetadata getPPMMetadata(const std::string& filename);
+// Todas las funciones de imagen están instanciadas para Pixel8 y Pixel16. Pixel8 solo admite
+// imágenes con valor máximo de hasta 255; Pixel16 admite las dos profundidades.
 
 // Función para escalar la intensidad de cada píxel al nuevo valor máximo
-void scaleIntensity(std::vector<Pixel>& pixels, int currentMax, int newMax);
+template <typename P>
+void scaleIntensity(std::vector<P>& pixels, int currentMax, int newMax);
+
+// Igual que scaleIntensity pero con el resultado en píxeles de otro tipo (cambio de profundidad)
+template <typename Out, typename In>
+std::vector<Out> scaleIntensityTo(const std::vector<In>& pixels, int currentMax, int newMax);
 
 // Función para cargar una imagen PPM en un vector de píxeles
-std::vector<Pixel> loadImage(const std::string& filename, const PPMMetadata& metadata);
+template <typename P = Pixel>
+std::vector<P> loadImage(const std::string& filename, const PPMMetadata& metadata);
+
+// Carga los píxeles de un archivo ya abierto, sin volver a leer la cabecera
+template <typename P = Pixel>
+std::vector<P> loadImage(const PPMFile& file);
+
+// Carga los píxeles directamente desde el formato comprimido, sin vector de índices completo
+template <typename P = Pixel>
+std::vector<P> loadImage(const CompressedFile& file);
+
+// Metadatos equivalentes de una imagen comprimida
+PPMMetadata getPPMMetadata(const CompressedFile& file);
 
-// Función para guardar un vector de píxeles en un archivo PPM
-void saveImage(const std::string& filename, const std::vector<Pixel>& pixels, const PPMMetadata& metadata);
+// Función para guardar un vector de píxeles en un archivo PPM; las muestras de 16 bits se
+// escriben en big-endian, como las lee loadImage
+template <typename P>
+void saveImage(const std::string& filename, const std::vector<P>& pixels, const PPMMetadata& metadata);
+
+// Guarda la imagen en el formato comprimido con tabla de colores (ver common/palette.hpp)
+template <typename P>
+void compressImage(const std::string& filename, const std::vector<P>& pixels, const PPMMetadata& metadata);
 
 // Función para redimensionar una imagen utilizando interpolación bilineal
-std::vector<Pixel> resizeImage(const std::vector<Pixel>& originalPixels, const PPMMetadata& originalMetadata, int newWidth, int newHeight);
+template <typename P>
+std::vector<P> resizeImage(const std::vector<P>& originalPixels, const PPMMetadata& originalMetadata, int newWidth, int newHeight);
+
+// Igual que resizeImage pero con los kernels de punto fijo de common/simdkernels.hpp; cada canal
+// difiere como máximo en 2 del resultado de resizeImage
+template <typename P>
+std::vector<P> resizeImageFixed(const std::vector<P>& originalPixels, const PPMMetadata& originalMetadata, int newWidth, int newHeight);
+
+// Redimensiona con uno de los filtros separables de common/resample.hpp (no bilinear) al tamaño
+// de newMetadata; las muestras se redondean y se limitan al valor máximo de la imagen
+template <typename P>
+std::vector<P> resampleImage(const std::vector<P>& originalPixels, const PPMMetadata& originalMetadata, const PPMMetadata& newMetadata, ResizeFilter filter);
 
 // Función para eliminar colores menos frecuentes de la imagen
-std::vector<Pixel> removeLeastFrequentColors(const std::vector<Pixel>& pixels, int n);
+template <typename P>
+std::vector<P> removeLeastFrequentColors(const std::vector<P>& pixels, int n);
 
 // Función para calcular la distancia entre colores
-int colorDistance(const Pixel& pixel1, const Pixel& pixel2);
+template <typename P>
+int colorDistance(const P& pixel1, const P& pixel2);
 
 // Función interpolate
-Pixel interpolate(const Pixel& pixel1, const Pixel& pixel2, double weight);
+template <typename P>
+P interpolate(const P& pixel1, const P& pixel2, double weight);
 
 double interpolateChannel(double channel1, double channel2, double weight);
 
@@ -3,6 +3,15 @@
 //
 #include "imagesoa.hpp"
 
+#include "common/binaryio.hpp"
+#include "common/colorhistogram.hpp"
+#include "common/colortree.hpp"
+#include "common/palette.hpp"
+#include "common/ratioresize.hpp"
+#include "common/simdkernels.hpp"
+#include "common/threadpool.hpp"
+
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstddef>
@@ -10,26 +19,502 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <queue>
+#include <span>
 #include <stdexcept>
 #include <unordered_map>
+#include <utility>
 
 PPMMetadata loadMetadata(std::string const & filepath) {
-  std::cerr << "Trying to open: " << filepath << '\n';
-  std::ifstream file(filepath, std::ios::binary);
-  if (!file.is_open()) { std::cerr << "Failed to open file" << '\n'; }
+  return loadMetadata(readPPMHeader(filepath));
+}
 
-  PPMMetadata metadata;
-  file >> metadata.magicNumber >> metadata.width >> metadata.height >> metadata.maxColorValue;
-  file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-  // Create the appropriate image object based on maxColorValue
-  return metadata;
+PPMMetadata loadMetadata(PPMHeader const & header) {
+  return PPMMetadata{.magicNumber   = header.magicNumber,
+                     .width         = header.width,
+                     .height        = header.height,
+                     .maxColorValue = header.maxColorValue};
+}
+
+PPMMetadata loadMetadata(CompressedFile const & file) {
+  return PPMMetadata{.magicNumber   = "P6",
+                     .width         = file.format().width,
+                     .height        = file.format().height,
+                     .maxColorValue = file.format().maxColorValue};
 }
 
 namespace {
   double interpolate(double const value1, double const value2, double const weight) {
     return value1 + (weight * (value2 - value1));
   }
+
+  // The file must describe an image of exactly this size and sample width
+  void checkLoadable(PPMFile const & file, ImageSOA const & image, size_t const sampleBytes) {
+    PPMHeader const & header = file.header();
+    if (header.width != image.gWidth() || header.height != image.gHeight() ||
+        header.sampleBytes() != sampleBytes) {
+      throw std::runtime_error("Image header does not match the loaded metadata: " + file.path());
+    }
+  }
+
+  void checkLoadable(CompressedFile const & file, ImageSOA const & image, size_t const sampleBytes) {
+    CompressedFormat const & format = file.format();
+    if (format.width != image.gWidth() || format.height != image.gHeight() ||
+        (format.maxColorValue > MAX_8BIT_VALUE ? 2U : 1U) != sampleBytes) {
+      throw std::runtime_error("Compressed image does not match the loaded metadata");
+    }
+  }
+
+  // Bilinear value at (x_target, y_target) of a channel read through fetch(x, y), so the same
+  // arithmetic serves row-major and tiled channels
+  template <typename Fetch>
+  double bilinearAt(Fetch const & fetch, Dimensions const original_dimensions,
+                    double const x_target, double const y_target) {
+    int const x_l = static_cast<int>(std::floor(x_target));
+    int x_h = static_cast<int>(std::ceil(x_target));
+    int const y_l = static_cast<int>(std::floor(y_target));
+    int y_h = static_cast<int>(std::ceil(y_target));
+    if (x_h >= static_cast<int>(original_dimensions.width)) { x_h = x_l; }
+    if (y_h >= static_cast<int>(original_dimensions.height)) { y_h = y_l; }
+    int const value_xl_yl = fetch(x_l, y_l);
+    int const value_xh_yl = fetch(x_h, y_l);
+    int const value_xl_yh = fetch(x_l, y_h);
+    int const value_xh_yh = fetch(x_h, y_h);
+    double weight_x = 0;
+    if (x_h - x_l != 0) { weight_x = (x_target - x_l) / (x_h - x_l); }
+    double const color1 = interpolate(value_xl_yl, value_xh_yl, weight_x);
+    double const color2 = interpolate(value_xl_yh, value_xh_yh, weight_x);
+    double weight_y = 0;
+    if (y_h - y_l != 0) { weight_y = (y_target - y_l) / (y_h - y_l); }
+    return interpolate(color1, color2, weight_y);
+  }
+
+  // Source size and the source distance between two neighbouring output pixels
+  struct ResizeGeometry {
+      Dimensions source;
+      double width_div  = 0;
+      double height_div = 0;
+  };
+
+  // Source samples and weight of the second one for one output column or row. The same
+  // arithmetic as bilinearAt, done once per coordinate instead of once per pixel.
+  struct BilinearTap {
+      size_t low    = 0;
+      size_t high   = 0;
+      double weight = 0;
+  };
+
+  std::vector<BilinearTap> bilinearTaps(size_t const outputs, size_t const sourceSize,
+                                        double const step) {
+    std::vector<BilinearTap> taps(outputs);
+    for (size_t i = 0; i < outputs; ++i) {
+      double const target = static_cast<double>(i) * step;
+      int const low = static_cast<int>(std::floor(target));
+      int high = static_cast<int>(std::ceil(target));
+      if (high >= static_cast<int>(sourceSize)) { high = low; }
+      double weight = 0;
+      if (high - low != 0) { weight = (target - low) / (high - low); }
+      taps[i] = {.low    = static_cast<size_t>(low),
+                 .high   = static_cast<size_t>(high),
+                 .weight = weight};
+    }
+    return taps;
+  }
+
+  struct ResizeTaps {
+      std::vector<BilinearTap> columns;
+      std::vector<BilinearTap> rows;
+  };
+
+  // Rounded bilinear value of every output pixel of region in every channel. fetch(x, y) returns
+  // the samples of all channels at a source pixel and store(x, y, values) takes their rounded
+  // values, so the neighbours and weights of a pixel are found once for all channels. Pixels
+  // landing exactly on a source sample get weights of 0, which yields that sample as is.
+  template <typename Fetch, typename Store>
+  void resizeRegion(Fetch const & fetch, Store const & store, ResizeTaps const & taps,
+                    TileRegion const & region) {
+    using Samples = decltype(fetch(size_t{0}, size_t{0}));
+    for (size_t new_y = region.y; new_y < region.y + region.height; new_y++) {
+      BilinearTap const row = taps.rows[new_y];
+      for (size_t new_x = region.x; new_x < region.x + region.width; new_x++) {
+        BilinearTap const column = taps.columns[new_x];
+        Samples const top_left     = fetch(column.low, row.low);
+        Samples const top_right    = fetch(column.high, row.low);
+        Samples const bottom_left  = fetch(column.low, row.high);
+        Samples const bottom_right = fetch(column.high, row.high);
+        std::array<double, std::tuple_size_v<Samples>> values{};
+        for (size_t channel = 0; channel < values.size(); ++channel) {
+          double const top = interpolate(top_left[channel], top_right[channel], column.weight);
+          double const bottom =
+            interpolate(bottom_left[channel], bottom_right[channel], column.weight);
+          values[channel] = std::round(interpolate(top, bottom, row.weight));
+        }
+        store(new_x, new_y, values);
+      }
+    }
+  }
+
+  // Output samples per resize band below which splitting further is not worth a task
+  constexpr size_t minResizeSamples = size_t{1} << 15U;
+
+  BilinearTaps fixedTaps(std::vector<BilinearTap> const & taps) {
+    BilinearTaps fixed;
+    fixed.low.reserve(taps.size());
+    fixed.high.reserve(taps.size());
+    fixed.weight.reserve(taps.size());
+    for (BilinearTap const & tap : taps) {
+      fixed.low.push_back(static_cast<uint32_t>(tap.low));
+      fixed.high.push_back(static_cast<uint32_t>(tap.high));
+      fixed.weight.push_back(bilinearWeight(tap.weight));
+    }
+    return fixed;
+  }
+
+  // Channels of one image to resize to dim, and the preallocated channels the results go to
+  template <typename Sample, size_t Channels>
+  struct ResizeJob {
+      std::array<std::vector<Sample> const *, Channels> sources;
+      std::array<std::vector<Sample> *, Channels> outputs;
+      ResizeGeometry geometry;
+      Dimensions dim;
+  };
+
+  // Resize every channel of job in bands of output rows spread over the shared pool, with the
+  // image's filter, layout and precision. Filters other than bilinear build their kernel plan
+  // once and store rounded, clamped samples. Bilinear exact: one pass over the output serves all
+  // channels, and convert turns an interpolated value into a sample; tiled, the sources are
+  // copied into tiles, bands are whole tile rows and each band is produced one output tile at a
+  // time. Bilinear fixed point: the plan is built once and every band of every channel runs the
+  // kernel. Bilinear exact with source steps of 4, 2, 1, 1/2 or 1/4 samples along both axes runs
+  // the integer kernels of common/ratioresize.hpp instead, whatever the layout.
+  template <typename Sample, size_t Channels, typename Convert>
+  void resizeChannels(ImageSOA const & image, ResizeJob<Sample, Channels> const & job,
+                      Convert const & convert) {
+    Dimensions const dim            = job.dim;
+    ResizeGeometry const & geometry = job.geometry;
+    RowBands shape = {.width = dim.width, .height = dim.height, .minSamples = minResizeSamples};
+    if (ResizeFilter const filter = image.gResizeFilter(); filter != ResizeFilter::bilinear) {
+      ResamplePlan const plan = {
+        .columns   = resampleKernels(filter, dim.width, geometry.source.width),
+        .rows      = resampleKernels(filter, dim.height, geometry.source.height),
+        .rowLength = geometry.source.width,
+        .maxValue  = image.gMaxColorValue()};
+      shape.channels = Channels;
+      forEachRowBand(sharedThreadPool(), shape,
+                     [&](size_t const channel, size_t const first, size_t const end) {
+                       resample(std::span<Sample const>(*job.sources[channel]), plan,
+                                RowRange{.first = first, .count = end - first},
+                                std::span<Sample>(*job.outputs[channel]));
+                     });
+      return;
+    }
+    if (image.gResizePrecision() == ResizePrecision::fixedPoint) {
+      BilinearPlan const plan = {
+        .columns = fixedTaps(bilinearTaps(dim.width, geometry.source.width, geometry.width_div)),
+        .rows = fixedTaps(bilinearTaps(dim.height, geometry.source.height, geometry.height_div)),
+        .rowLength = geometry.source.width};
+      shape.channels = Channels;
+      forEachRowBand(sharedThreadPool(), shape,
+                     [&](size_t const channel, size_t const first, size_t const end) {
+                       bilinearResize(std::span<Sample const>(*job.sources[channel]), plan,
+                                      RowRange{.first = first, .count = end - first},
+                                      std::span<Sample>(*job.outputs[channel]));
+                     });
+      return;
+    }
+    std::optional<RatioAxis> const columns =
+      ratioAxis(geometry.width_div, geometry.source.width, dim.width);
+    std::optional<RatioAxis> const rows =
+      ratioAxis(geometry.height_div, geometry.source.height, dim.height);
+    if (columns && rows) {
+      RatioPlan const plan = {
+        .columns = *columns, .rows = *rows, .channels = 1, .rounding = RatioRounding::once};
+      shape.channels = Channels;
+      forEachRowBand(sharedThreadPool(), shape,
+                     [&](size_t const channel, size_t const first, size_t const end) {
+                       std::span<Sample> const output(*job.outputs[channel]);
+                       ratioResize(std::span<Sample const>(*job.sources[channel]), plan,
+                                   RowRange{.first = first, .count = end - first}, output);
+                       // convert takes the rounded value, as in resizeRegion
+                       for (Sample & sample :
+                            output.subspan(first * dim.width, (end - first) * dim.width)) {
+                         sample = convert(static_cast<double>(sample));
+                       }
+                     });
+      return;
+    }
+    ResizeTaps const taps = {
+      .columns = bilinearTaps(dim.width, geometry.source.width, geometry.width_div),
+      .rows    = bilinearTaps(dim.height, geometry.source.height, geometry.height_div)};
+    // Raw pointers captured by value: stores through a byte pointer could otherwise alias the
+    // vectors and force them to be reloaded on every sample
+    std::array<Sample *, Channels> outputs{};
+    std::array<Sample const *, Channels> sources{};
+    for (size_t channel = 0; channel < Channels; ++channel) {
+      outputs[channel] = job.outputs[channel]->data();
+      sources[channel] = job.sources[channel]->data();
+    }
+    auto const store = [outputs, &convert, dim](size_t const new_x, size_t const new_y,
+                                                std::array<double, Channels> const & values) {
+      size_t const index = (new_y * dim.width) + new_x;
+      for (size_t channel = 0; channel < Channels; ++channel) {
+        outputs[channel][index] = convert(values[channel]);
+      }
+    };
+    if (image.gLayout() == ChannelLayout::tiled) {
+      std::vector<TiledChannel<Sample>> tiled;
+      tiled.reserve(Channels);
+      for (std::vector<Sample> const * source : job.sources) {
+        tiled.emplace_back(*source, geometry.source.width, geometry.source.height);
+      }
+      auto const fetch = [&tiled](size_t const x_coord, size_t const y_coord) {
+        size_t const position = tiled.front().offset(x_coord, y_coord);
+        std::array<int, Channels> samples{};
+        for (size_t channel = 0; channel < Channels; ++channel) {
+          samples[channel] = tiled[channel].atOffset(position);
+        }
+        return samples;
+      };
+      shape.rowAlign = tileSize;
+      forEachRowBand(sharedThreadPool(), shape, [&](size_t, size_t const first, size_t const end) {
+        forEachTileRegion(dim.width, first, end, [&](TileRegion const & region) {
+          resizeRegion(fetch, store, taps, region);
+        });
+      });
+      return;
+    }
+    size_t const width = geometry.source.width;
+    auto const fetch   = [sources, width](size_t const x_coord, size_t const y_coord) {
+      size_t const index = (y_coord * width) + x_coord;
+      std::array<int, Channels> samples{};
+      for (size_t channel = 0; channel < Channels; ++channel) {
+        samples[channel] = sources[channel][index];
+      }
+      return samples;
+    };
+    forEachRowBand(sharedThreadPool(), shape, [&](size_t, size_t const first, size_t const end) {
+      resizeRegion(fetch, store, taps,
+                   TileRegion{.y = first, .width = dim.width, .height = end - first});
+    });
+  }
+
+  Dimensions sizeOf(ImageSOA const & image) {
+    return {.width = image.gWidth(), .height = image.gHeight()};
+  }
+
+  // 8-bit resize: the first and last output pixels of a row or column land on the first and last
+  // source pixels
+  ResizeGeometry cornerGeometry(Dimensions const source, Dimensions const dim) {
+    auto const new_width  = static_cast<double>(dim.width);
+    auto const new_height = static_cast<double>(dim.height);
+    auto const width      = static_cast<double>(source.width);
+    auto const height     = static_cast<double>(source.height);
+    return {.source     = source,
+            .width_div  = ((width - 1) / (new_width - 1)),
+            .height_div = ((height - 1) / (new_height - 1))};
+  }
+
+  // 16-bit resize: output pixels step through the source by the size ratio from the top left
+  ResizeGeometry stepGeometry(Dimensions const source, Dimensions const dim) {
+    auto const new_width  = static_cast<double>(dim.width);
+    auto const new_height = static_cast<double>(dim.height);
+    auto const width      = static_cast<double>(source.width);
+    auto const height     = static_cast<double>(source.height);
+    return {.source     = source,
+            .width_div  = (width / new_width),
+            .height_div = (height / new_height)};
+  }
+
+  // The exact 16-bit path keeps only the low byte of each sample, which existing outputs depend on
+  uint16_t lowByte(double const value) { return static_cast<uint8_t>(value); }
+
+  uint8_t toSample8(double const value) { return static_cast<uint8_t>(value); }
+
+  // The three channels of job resized into new buffers, which job.outputs is pointed at here
+  template <typename Sample, typename Convert>
+  std::array<std::vector<Sample>, 3> resizedChannels(ImageSOA const & image,
+                                                     ResizeJob<Sample, 3> job,
+                                                     Convert const & convert) {
+    std::array<std::vector<Sample>, 3> resized;
+    for (size_t channel = 0; channel < resized.size(); ++channel) {
+      resized[channel]     = ChannelBuffers<Sample>::acquire(job.dim.width * job.dim.height);
+      job.outputs[channel] = &resized[channel];
+    }
+    resizeChannels(image, job, convert);
+    return resized;
+  }
+
+  // The two most recent source rows of a streamed resize, split into channels. Bilinear output
+  // rows read source rows low and low + 1 (low twice at the bottom edge), in increasing order, so
+  // row r is kept in slot r % 2 and each needed row is read from the file once.
+  template <typename Sample>
+  class RowRing {
+    public:
+      RowRing(std::istream & input, PPMHeader const & header)
+        : input(input), payloadOffset(header.payloadOffset),
+          rowBytes(header.width * 3 * header.sampleBytes()), bytes(rowBytes) {
+        for (auto & slot : slots) {
+          for (auto & channel : slot) { channel.resize(header.width); }
+        }
+      }
+
+      // Make source row available in its slot, seeking past the rows no output row reads
+      void load(size_t const row) {
+        if (held[row % 2] == row) { return; }
+        if (row != nextRow) {
+          input.seekg(static_cast<std::streamoff>(payloadOffset + (row * rowBytes)));
+        }
+        input.read(reinterpret_cast<char *>(bytes.data()), // NOLINT(*-pro-type-reinterpret-cast)
+                   static_cast<std::streamsize>(rowBytes));
+        if (!input) { throw std::runtime_error("Failed to read pixel data"); }
+        auto & slot = slots[row % 2];
+        if constexpr (sizeof(Sample) == 1) {
+          deinterleave8(bytes, slot[0], slot[1], slot[2]);
+        } else {
+          deinterleave16BE(bytes, slot[0], slot[1], slot[2]);
+        }
+        held[row % 2] = row;
+        nextRow       = row + 1;
+      }
+
+      [[nodiscard]] std::array<int, 3> at(size_t const x_coord, size_t const row) const {
+        auto const & slot = slots[row % 2];
+        return {slot[0][x_coord], slot[1][x_coord], slot[2][x_coord]};
+      }
+
+    private:
+      std::istream & input;
+      size_t payloadOffset;
+      size_t rowBytes;
+      std::vector<uint8_t> bytes;
+      std::array<std::array<std::vector<Sample>, 3>, 2> slots;
+      std::array<size_t, 2> held = {SIZE_MAX, SIZE_MAX};
+      size_t nextRow             = 0;
+  };
+
+  // Input opened at its payload, its header and the output file of a streamed resize
+  struct ResizeStream {
+      std::istream & input;
+      PPMHeader header;
+      std::string output;
+  };
+
+  // Output rows of the exact bilinear resize computed from a RowRing and written one by one,
+  // with the taps, interpolation and convert of the in-memory path
+  template <typename Sample, typename Convert>
+  void streamResizeRows(ResizeStream const & stream, ResizeGeometry const & geometry,
+                        Dimensions const dim, Convert const & convert) {
+    PPMHeader const & header = stream.header;
+    ResizeTaps const taps = {
+      .columns = bilinearTaps(dim.width, header.width, geometry.width_div),
+      .rows    = bilinearTaps(dim.height, header.height, geometry.height_div)};
+    RowRing<Sample> ring(stream.input, header);
+    std::array<std::vector<Sample>, 3> row;
+    for (auto & channel : row) { channel.resize(dim.width); }
+    PPMWriter writer(stream.output);
+    writer.writeHeader(dim.width, dim.height, header.maxColorValue);
+    auto const fetch = [&ring](size_t const x_coord, size_t const y_coord) {
+      return ring.at(x_coord, y_coord);
+    };
+    auto const store = [&row, &convert](size_t const new_x, size_t,
+                                        std::array<double, 3> const & values) {
+      for (size_t channel = 0; channel < row.size(); ++channel) {
+        row[channel][new_x] = convert(values[channel]);
+      }
+    };
+    for (size_t new_y = 0; new_y < dim.height; ++new_y) {
+      ring.load(taps.rows[new_y].low);
+      ring.load(taps.rows[new_y].high);
+      resizeRegion(fetch, store, taps, TileRegion{.y = new_y, .width = dim.width, .height = 1});
+      if constexpr (sizeof(Sample) == 1) {
+        writer.writePixels8(row[0], row[1], row[2]);
+      } else {
+        writer.writePixels16BE(row[0], row[1], row[2]);
+      }
+    }
+  }
+
+  // Samples per band below which splitting a channel further is not worth a task
+  constexpr size_t minBandSamples = size_t{1} << 18U;
+
+  // Call body(channel, begin, end) for bands of whole rows of the three channels, spread over the
+  // shared pool. Bands do not overlap and their bounds depend only on the image size and the pool
+  // size, and every sample is computed independently, so the result is the same for any thread
+  // count.
+  template <typename Body>
+  void forEachChannelBand(size_t const width, size_t const height, Body const & body,
+                          size_t const channels = 3) {
+    RowBands const shape = {
+      .width = width, .height = height, .channels = channels, .minSamples = minBandSamples};
+    forEachRowBand(sharedThreadPool(), shape,
+                   [&](size_t const channel, size_t const first, size_t const end) {
+                     body(channel, first * width, end * width);
+                   });
+  }
+
+  // Rescale the channels of image into channels of the other sample width, one channel at a
+  // time. Each source channel is freed (not cached) once its copy is complete, so the conversion
+  // peaks at the source image plus one converted channel rather than both images.
+  template <typename Out, typename In>
+  std::array<std::vector<Out>, 3> convertChannels(ImageSOA const & image,
+                                                  std::array<std::vector<In> *, 3> const & sources,
+                                                  LevelScale const scale) {
+    std::array<std::vector<Out>, 3> targets;
+    for (size_t channel = 0; channel < targets.size(); ++channel) {
+      targets[channel] = ChannelBuffers<Out>::acquire(image.gWidth() * image.gHeight());
+      std::span<In const> const source(*sources[channel]);
+      std::span<Out> const target(targets[channel]);
+      forEachChannelBand(
+        image.gWidth(), image.gHeight(),
+        [&](size_t, size_t const begin, size_t const end) {
+          scaleSamples(source.subspan(begin, end - begin), target.subspan(begin, end - begin),
+                       scale);
+        },
+        1);
+      std::vector<In>().swap(*sources[channel]);
+    }
+    return targets;
+  }
+
+  // Call visit(begin, end) for runs of row-major pixel indices covering the image: the whole
+  // image at once, or every tile row of every tile when the image uses the tiled layout
+  template <typename Visit>
+  void forEachRun(ImageSOA const & image, Visit const & visit) {
+    size_t const width = image.gWidth();
+    if (image.gLayout() != ChannelLayout::tiled) {
+      visit(size_t{0}, width * image.gHeight());
+      return;
+    }
+    forEachTileRegion(width, image.gHeight(), [&](TileRegion const & region) {
+      for (size_t y_coord = region.y; y_coord < region.y + region.height; ++y_coord) {
+        size_t const begin = (y_coord * width) + region.x;
+        visit(begin, begin + region.width);
+      }
+    });
+  }
+
+  template <typename Color>
+  ColorKey keyOf(Color const & color) {
+    return {color.r, color.g, color.b};
+  }
+
+  // Nearest of candidates to every target through a k-d tree; of equally near candidates the
+  // first one wins, as in a scan of candidates keeping only strictly nearer colors
+  template <typename Color>
+  std::unordered_map<Color, Color> nearestColors(std::vector<Color> const & targets,
+                                                 std::vector<Color> const & candidates) {
+    std::vector<ColorKey> keys;
+    keys.reserve(candidates.size());
+    for (Color const & candidate : candidates) { keys.push_back(keyOf(candidate)); }
+    ColorTree const tree(keys);
+    std::unordered_map<Color, Color> nearest;
+    nearest.reserve(targets.size());
+    for (Color const & target : targets) {
+      nearest[target] = candidates[tree.nearest(keyOf(target))];
+    }
+    return nearest;
+  }
 } // namespace
 
 bool ImageSOA_8bit::operator==(ImageSOA_8bit const & other) const {
@@ -46,14 +531,14 @@ bool ImageSOA_8bit::operator==(ImageSOA_8bit const & other) const {
     return false;
   }
   constexpr int max_pixel_offset = 3;
-  // Check if the pixel data in each channel is similar within a difference of 5
-  for (size_t i = 0; i < this->red.size(); ++i) {
-    if (std::abs(this->red[i] - other.red[i]) >= max_pixel_offset ||
-        std::abs(this->green[i] - other.green[i]) >= max_pixel_offset ||
-        std::abs(this->blue[i] - other.blue[i]) >= max_pixel_offset) {
-      std::cout << "Byte difference exceeds 3 at index: " << i << '\n';
-      return false;
-    }
+  // Check if the pixel data in each channel is similar within a difference of 3; the first
+  // offending pixel is the earliest one over all three channels
+  size_t const mismatch = std::min({firstDifference(red, other.red, max_pixel_offset),
+                                    firstDifference(green, other.green, max_pixel_offset),
+                                    firstDifference(blue, other.blue, max_pixel_offset)});
+  if (mismatch < this->red.size()) {
+    std::cout << "Byte difference exceeds 3 at index: " << mismatch << '\n';
+    return false;
   }
 
   // If all checks pass, the images are considered equal
@@ -74,87 +559,46 @@ bool ImageSOA_16bit::operator==(ImageSOA_16bit const & other) const {
     return false;
   }
   constexpr int max_pixel_offset = 3;
-  // Check if the pixel data in each channel is similar within a difference of 5
-  for (size_t i = 0; i < this->red.size(); ++i) {
-    if (std::abs(this->red[i] - other.red[i]) >= max_pixel_offset ||
-        std::abs(this->green[i] - other.green[i]) >= max_pixel_offset ||
-        std::abs(this->blue[i] - other.blue[i]) >= max_pixel_offset) {
-      std::cout << "Byte difference exceeds 3 at index: " << i << '\n';
-      return false;
-    }
+  // Check if the pixel data in each channel is similar within a difference of 3; the first
+  // offending pixel is the earliest one over all three channels
+  size_t const mismatch = std::min({firstDifference(red, other.red, max_pixel_offset),
+                                    firstDifference(green, other.green, max_pixel_offset),
+                                    firstDifference(blue, other.blue, max_pixel_offset)});
+  if (mismatch < this->red.size()) {
+    std::cout << "Byte difference exceeds 3 at index: " << mismatch << '\n';
+    return false;
   }
 
   // If all checks pass, the images are considered equal
   return true;
 }
 
-void ImageSOA_8bit::loadData(std::string const & filepath) {
-  std::ifstream file(filepath, std::ios::binary);
-  file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-  if (!file.is_open()) {
-    std::cerr << "Error: Failed to open the file." << '\n';
-  }
-  size_t width = 0;
-  size_t height = 0;
-  size_t maxColorValue = 0;
-  file >> width >> height >> maxColorValue;
-  if (width != gWidth() || height != gHeight()) {
-    std::cerr << "Error: Image dimensions do not match expected size.\n";
-  }
-  file.ignore(1, '\n');
-  uint8_t red = 0;
-  uint8_t green = 0;
-  uint8_t blue = 0;
-  // Read pixel data (each pixel consists of 3 bytes: R, G, B)
-  size_t const size = gWidth() * gHeight();
-  for (size_t i = 0; i < size; ++i) {
-    file.read(reinterpret_cast<char *>(&red), // NOLINT(*-pro-type-reinterpret-cast)
-              sizeof(red));
-    file.read(reinterpret_cast<char *>(&green), // NOLINT(*-pro-type-reinterpret-cast)
-              sizeof(green));
-    file.read(reinterpret_cast<char *>(&blue), // NOLINT(*-pro-type-reinterpret-cast)
-              sizeof(blue));
-    if (!file) {
-      std::cerr << "Error: Failed to read pixel data.\n";
-    }
-    // Assign the values to the respective channels
-    gRed()[i] = red;
-    gGreen()[i] = green;
-    gBlue()[i] = blue;
-  }
-  // Check if file reading was successful
-  if (file.fail()) {
-    std::cerr << "Error: File reading error occurred.\n";
-  }
-}
+void ImageSOA_8bit::loadData(std::string const & filepath) { loadData(PPMFile(filepath)); }
 
-void ImageSOA_8bit::saveToFile(std::string const & filename) {
-  std::ofstream file(filename, std::ios::out | std::ios::binary);
+void ImageSOA_8bit::loadData(PPMFile const & file) {
+  checkLoadable(file, *this, 1);
+  // Single pass over the mapped payload straight into the three channels
+  deinterleave8(file.payload(), red, green, blue);
+}
 
-  // Check if the file is opened successfully
-  if (!file.is_open()) {
-    std::cerr << "Error: Failed to open file for saving.\n";
-  }
+void ImageSOA_8bit::loadData(CompressedFile const & file) {
+  checkLoadable(file, *this, 1);
+  decodeChannels<uint8_t>(file, red, green, blue);
+}
 
-  // Write the PPM header for P6 format
-  file << "P6\n";
-  file << gWidth() << " " << gHeight() << "\n";
-  file << static_cast<int>(gMaxColorValue()) << "\n";
-  // Write pixel data (each pixel consists of 3 bytes: R, G, B)
-  size_t const size = gWidth() * gHeight();
-  for (size_t i = 0; i < size; ++i) {
-    uint8_t red = gRed()[i];
-    uint8_t green = gGreen()[i];
-    uint8_t blue = gBlue()[i];
-    file.write(reinterpret_cast<char const *>(&red), // NOLINT(*-pro-type-reinterpret-cast)
-               sizeof(red));
-    file.write(reinterpret_cast<char const *>(&green), // NOLINT(*-pro-type-reinterpret-cast)
-               sizeof(green));
-    file.write(reinterpret_cast<char const *>(&blue), // NOLINT(*-pro-type-reinterpret-cast)
-               sizeof(blue));
-  }
+void ImageSOA_8bit::saveToFile(std::string const & filename) {
+  PPMWriter writer(filename);
+  writer.writeHeader(gWidth(), gHeight(), gMaxColorValue());
+  // Pixels are interleaved chunk by chunk and written in large blocks
+  writer.writePixels8(red, green, blue);
+}
 
-  file.close();
+void ImageSOA_8bit::compress(std::string const & filename) const {
+  Palette const palette = buildPalette(
+    red.size(), [this](size_t const i) { return colorKey(red[i], green[i], blue[i]); });
+  CompressedFormat const format = {
+    .width = gWidth(), .height = gHeight(), .maxColorValue = gMaxColorValue()};
+  saveCompressed(filename, format, palette);
 }
 
 // Scale intensity for each channel (for 8-bit values)
@@ -162,16 +606,13 @@ void ImageSOA_8bit::maxLevel(uint const newMax) {
   if (newMax > MAX_8BIT_VALUE) {
     std::cerr << "Error: newMax surpasses the 8-bit int limit, use the other scaling function.\n";
   }
-  auto const scale = static_cast<float>(newMax) / static_cast<float>(gMaxColorValue());
-  for (uint8_t & subpixel : red) {
-    subpixel = static_cast<uint8_t>(std::floor(static_cast<float>(subpixel) * scale));
-  }
-  for (uint8_t & subpixel : green) {
-    subpixel = static_cast<uint8_t>(std::floor(static_cast<float>(subpixel) * scale));
-  }
-  for (uint8_t & subpixel : blue) {
-    subpixel = static_cast<uint8_t>(std::floor(static_cast<float>(subpixel) * scale));
-  }
+  LevelScale const scale = {.currentMax = gMaxColorValue(), .newMax = newMax};
+  std::array<std::vector<uint8_t> *, 3> const channels = {&red, &green, &blue};
+  forEachChannelBand(gWidth(), gHeight(), [&](size_t const channel, size_t const begin,
+                                              size_t const end) {
+    std::span<uint8_t> const band = std::span(*channels[channel]).subspan(begin, end - begin);
+    scaleSamples(band, band, scale);
+  });
   sMaxColorValue(newMax);
 }
 
@@ -190,143 +631,66 @@ std::unique_ptr<ImageSOA_16bit> ImageSOA_8bit::maxLevelChangeChannelSize(uint co
 
   auto image = std::make_unique<ImageSOA_16bit>(metadata);
 
-  auto const scale = static_cast<float>(newMax) / static_cast<float>(gMaxColorValue());
-
-  auto const & originalRed = gRed();
-  auto & newRed = image->gRed();
-  for (size_t i = 0; i < originalRed.size(); ++i) {
-    newRed[i] = static_cast<uint16_t>(std::floor(static_cast<float>(originalRed[i]) * scale));
-  }
-
-  auto const & originalGreen = gGreen();
-  auto & newGreen = image->gGreen();
-  for (size_t i = 0; i < originalGreen.size(); ++i) {
-    newGreen[i] = static_cast<uint16_t>(std::floor(static_cast<float>(originalGreen[i]) * scale));
-  }
-
-  auto const & originalBlue = gBlue();
-  auto & newBlue = image->gBlue();
-  for (size_t i = 0; i < originalBlue.size(); ++i) {
-    newBlue[i] = static_cast<uint16_t>(std::floor(static_cast<float>(originalBlue[i]) * scale));
-  }
+  LevelScale const scale = {.currentMax = gMaxColorValue(), .newMax = newMax};
+  std::array<std::vector<uint8_t> *, 3> const sources = {&red, &green, &blue};
+  std::array<std::vector<uint16_t> *, 3> const targets = {&image->gRed(), &image->gGreen(),
+                                                      &image->gBlue()};
+  forEachChannelBand(gWidth(), gHeight(), [&](size_t const channel, size_t const begin,
+                                              size_t const end) {
+    scaleSamples(std::span<uint8_t const>(*sources[channel]).subspan(begin, end - begin),
+                 std::span(*targets[channel]).subspan(begin, end - begin), scale);
+  });
   return image;
 }
 
-void ImageSOA_16bit::loadData(std::string const & filepath) {
-  std::ifstream file(filepath, std::ios::binary);
-  file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-  if (!file.is_open()) {
-    std::cerr << "Error: Failed to open the file.\n";
-  }
-  size_t width = 0;
-  size_t height = 0;
-  size_t maxColorValue = 0;
-  file >> width >> height >> maxColorValue;
-  if (width != gWidth() || height != gHeight()) {
-    std::cerr << "Error: Image dimensions do not match expected size.\n";
-  }
-  file.ignore(1, '\n');
-  uint16_t red = 0;
-  uint16_t green = 0;
-  uint16_t blue = 0;
-  size_t const size = gWidth() * gHeight();
-  for (size_t i = 0; i < size; ++i) {
-    file.read(reinterpret_cast<char *>(&red), // NOLINT(*-pro-type-reinterpret-cast)
-              2);
-    file.read(reinterpret_cast<char *>(&green), // NOLINT(*-pro-type-reinterpret-cast)
-              2);
-    file.read(reinterpret_cast<char *>(&blue), // NOLINT(*-pro-type-reinterpret-cast)
-              2);
-    if (!file) {
-      std::cerr << "Error: Failed to read pixel data.\n";
-    }
-    gRed()[i] = red;
-    gGreen()[i] = green;
-    gBlue()[i] = blue;
+ImageSOA_16bit ImageSOA_8bit::toSixteenBit(uint const newMax) && {
+  if (newMax > MAX_16BIT_VALUE) {
+    std::cerr << "Error: newMax exceeds the 16-bit integer range.\n";
   }
-  // Check if file reading was successful
-  if (file.fail()) {
-    std::cerr << "Error: File reading error occurred.\n";
+  if (newMax <= MAX_8BIT_VALUE) {
+    std::cerr << "Error: newMax is within 8-bit range; this function is not necessary.\n";
   }
+  PPMMetadata const metadata = {.magicNumber = gMagicNumber(),
+                                .width = gWidth(),
+                                .height = gHeight(),
+                                .maxColorValue = newMax};
+  LevelScale const scale = {.currentMax = gMaxColorValue(), .newMax = newMax};
+  return {metadata, convertChannels<uint16_t, uint8_t>(*this, {&red, &green, &blue}, scale)};
 }
 
-void ImageSOA_16bit::saveToFile(std::string const & filename) {
-  std::ofstream file(filename, std::ios::out | std::ios::binary);
+void ImageSOA_16bit::loadData(std::string const & filepath) { loadData(PPMFile(filepath)); }
 
-  // Check if the file is opened successfully
-  if (!file.is_open()) {
-    std::cerr << "Error: Failed to open file for saving.\n";
-  }
-
-  // Write the PPM header for P6 format
-  file << "P6\n";
-  file << gWidth() << " " << gHeight() << "\n";
-  file << static_cast<int>(gMaxColorValue()) << "\n";
-
-  // Write pixel data (each pixel consists of 6 bytes: R, G, B, each 2 bytes)
-  uint16_t const hex_ff = 0xFF;
-  uint16_t const shift_value = 8;
-  size_t const size = gWidth() * gHeight();
-  for (size_t i = 0; i < size; ++i) {
-    uint16_t const red = gRed()[i];
-    uint16_t const green = gGreen()[i];
-    uint16_t const blue = gBlue()[i];
-
-    // Use std::array instead of C-style array
-    std::array<char, 2> redBytes = {static_cast<char>(red & hex_ff),
-                                    static_cast<char>((red >> shift_value) & hex_ff)};
-    std::array<char, 2> greenBytes = {static_cast<char>(green & hex_ff),
-                                      static_cast<char>((green >> shift_value) & hex_ff)};
-    std::array<char, 2> blueBytes = {static_cast<char>(blue & hex_ff),
-                                     static_cast<char>((blue >> shift_value) & hex_ff)};
+void ImageSOA_16bit::loadData(PPMFile const & file) {
+  checkLoadable(file, *this, sizeof(uint16_t));
+  // PPM stores 16-bit samples big-endian
+  deinterleave16BE(file.payload(), red, green, blue);
+}
 
-    // Write the bytes to the file
-    file.write(redBytes.data(), 2);
-    file.write(greenBytes.data(), 2);
-    file.write(blueBytes.data(), 2);
-  }
+void ImageSOA_16bit::loadData(CompressedFile const & file) {
+  checkLoadable(file, *this, sizeof(uint16_t));
+  decodeChannels<uint16_t>(file, red, green, blue);
+}
 
-  file.close();
+void ImageSOA_16bit::saveToFile(std::string const & filename) {
+  PPMWriter writer(filename);
+  writer.writeHeader(gWidth(), gHeight(), gMaxColorValue());
+  // Samples are written in host (little-endian) byte order
+  writer.writePixels16LE(red, green, blue);
 }
 
 void ImageSOA_16bit::saveToFileBE(std::string const & filename) {
-  std::ofstream file(filename, std::ios::out | std::ios::binary);
-
-  // Check if the file is opened successfully
-  if (!file.is_open()) {
-    std::cerr << "Error: Failed to open file for saving.\n";
-  }
-
-  // Write the PPM header for P6 format
-  file << "P6\n";
-  file << gWidth() << " " << gHeight() << "\n";
-  file << static_cast<int>(gMaxColorValue()) << "\n";
-
-  // Write pixel data (each pixel consists of 6 bytes: R, G, B, each 2 bytes)
-  uint16_t const hex_ff = 0xFF;
-  uint16_t const shift_value = 8;
-  size_t const size = gWidth() * gHeight();
-
-  for (size_t i = 0; i < size; ++i) {
-    uint16_t const red = gRed()[i];
-    uint16_t const green = gGreen()[i];
-    uint16_t const blue = gBlue()[i];
-
-    // Invert the byte order for each channel
-    std::array<char, 2> redBytes = {static_cast<char>((red >> shift_value) & hex_ff),
-                                    static_cast<char>(red & hex_ff)};
-    std::array<char, 2> greenBytes = {static_cast<char>((green >> shift_value) & hex_ff),
-                                      static_cast<char>(green & hex_ff)};
-    std::array<char, 2> blueBytes = {static_cast<char>((blue >> shift_value) & hex_ff),
-                                     static_cast<char>(blue & hex_ff)};
-
-    // Write the inverted bytes to the file
-    file.write(redBytes.data(), 2);
-    file.write(greenBytes.data(), 2);
-    file.write(blueBytes.data(), 2);
-  }
+  PPMWriter writer(filename);
+  writer.writeHeader(gWidth(), gHeight(), gMaxColorValue());
+  // Samples are byte-swapped to big-endian while being interleaved
+  writer.writePixels16BE(red, green, blue);
+}
 
-  file.close();
+void ImageSOA_16bit::compress(std::string const & filename) const {
+  Palette const palette = buildPalette(
+    red.size(), [this](size_t const i) { return colorKey(red[i], green[i], blue[i]); });
+  CompressedFormat const format = {
+    .width = gWidth(), .height = gHeight(), .maxColorValue = gMaxColorValue()};
+  saveCompressed(filename, format, palette);
 }
 
 // Scale intensity for each channel (for 16-bit values)
@@ -337,16 +701,13 @@ void ImageSOA_16bit::maxLevel(uint const newMax) {
   if (MAX_8BIT_VALUE >= newMax) {
     throw std::invalid_argument("newMax is inside the 8 bit int limit, convert to 8 bit image");
   }
-  auto const scale = static_cast<float>(newMax) / static_cast<float>(gMaxColorValue());
-  for (uint16_t & subpixel : red) {
-    subpixel = static_cast<uint16_t>(std::floor(static_cast<float>(subpixel) * scale));
-  }
-  for (uint16_t & subpixel : green) {
-    subpixel = static_cast<uint16_t>(std::floor(static_cast<float>(subpixel) * scale));
-  }
-  for (uint16_t & subpixel : blue) {
-    subpixel = static_cast<uint16_t>(std::floor(static_cast<float>(subpixel) * scale));
-  }
+  LevelScale const scale = {.currentMax = gMaxColorValue(), .newMax = newMax};
+  std::array<std::vector<uint16_t> *, 3> const channels = {&red, &green, &blue};
+  forEachChannelBand(gWidth(), gHeight(), [&](size_t const channel, size_t const begin,
+                                              size_t const end) {
+    std::span<uint16_t> const band = std::span(*channels[channel]).subspan(begin, end - begin);
+    scaleSamples(band, band, scale);
+  });
   sMaxColorValue(newMax);
 }
 
@@ -368,26 +729,31 @@ std::unique_ptr<ImageSOA_8bit> ImageSOA_16bit::maxLevelChangeChannelSize(uint co
   // Create a new 16-bit image with the updated metadata
   auto image = std::make_unique<ImageSOA_8bit>(metadata);
 
-  auto const scale = static_cast<float>(newMax) / static_cast<float>(gMaxColorValue());
-
-  auto const & originalRed = gRed();
-  auto & newRed = image->gRed();
-  for (size_t i = 0; i < originalRed.size(); ++i) {
-    newRed[i] = static_cast<uint8_t>(std::floor(static_cast<float>(originalRed[i]) * scale));
-  }
+  LevelScale const scale = {.currentMax = gMaxColorValue(), .newMax = newMax};
+  std::array<std::vector<uint16_t> *, 3> const sources = {&red, &green, &blue};
+  std::array<std::vector<uint8_t> *, 3> const targets = {&image->gRed(), &image->gGreen(),
+                                                      &image->gBlue()};
+  forEachChannelBand(gWidth(), gHeight(), [&](size_t const channel, size_t const begin,
+                                              size_t const end) {
+    scaleSamples(std::span<uint16_t const>(*sources[channel]).subspan(begin, end - begin),
+                 std::span(*targets[channel]).subspan(begin, end - begin), scale);
+  });
+  return image;
+}
 
-  auto const & originalGreen = gGreen();
-  auto & newGreen = image->gGreen();
-  for (size_t i = 0; i < originalGreen.size(); ++i) {
-    newGreen[i] = static_cast<uint8_t>(std::floor(static_cast<float>(originalGreen[i]) * scale));
+ImageSOA_8bit ImageSOA_16bit::toEightBit(uint const newMax) && {
+  if (newMax > MAX_16BIT_VALUE) {
+    throw std::invalid_argument("newMax exceeds the 16-bit integer range");
   }
-
-  auto const & originalBlue = gBlue();
-  auto & newBlue = image->gBlue();
-  for (size_t i = 0; i < originalBlue.size(); ++i) {
-    newBlue[i] = static_cast<uint8_t>(std::floor(static_cast<float>(originalBlue[i]) * scale));
+  if (newMax > MAX_8BIT_VALUE) {
+    throw std::invalid_argument("newMax is within 16-bit range; this function is not necessary");
   }
-  return image;
+  PPMMetadata const metadata = {.magicNumber = gMagicNumber(),
+                                .width = gWidth(),
+                                .height = gHeight(),
+                                .maxColorValue = newMax};
+  LevelScale const scale = {.currentMax = gMaxColorValue(), .newMax = newMax};
+  return {metadata, convertChannels<uint8_t, uint16_t>(*this, {&red, &green, &blue}, scale)};
 }
 
 int ImageSOA_8bit::calculatePosition(Point const point, Dimensions dim) {
@@ -407,79 +773,48 @@ int ImageSOA_8bit::calculatePosition(Point const point, Dimensions dim) {
 
 void ImageSOA_8bit::resize(Dimensions const dim) {
   std::cout << dim.width << "   " << dim.height << '\n';
-  // Replace the old channels with the new resized ones
-  red = resize_helper(red, dim);
-  green = resize_helper(green, dim);
-  blue = resize_helper(blue, dim);
+  // The resized channels replace the old ones, whose buffers go back to the cache with result
+  ImageSOA_8bit result = resized(dim);
+  std::swap(red, result.red);
+  std::swap(green, result.green);
+  std::swap(blue, result.blue);
   sWidth(dim.width);
   sHeight(dim.height);
 }
 
+ImageSOA_8bit ImageSOA_8bit::resized(Dimensions const dim) const {
+  // One pass over the output for the three channels
+  PPMMetadata const metadata = {.magicNumber   = gMagicNumber(),
+                                .width         = dim.width,
+                                .height        = dim.height,
+                                .maxColorValue = gMaxColorValue()};
+  ResizeJob<uint8_t, 3> const job = {.sources  = {&red, &green, &blue},
+                                     .outputs  = {},
+                                     .geometry = cornerGeometry(sizeOf(*this), dim),
+                                     .dim      = dim};
+  ImageSOA_8bit result(metadata, resizedChannels(*this, job, toSample8));
+  result.sSettingsOf(*this);
+  return result;
+}
+
 double ImageSOA_8bit::helper_resizeInterpolate(std::vector<uint8_t> & channel,
                                                Dimensions const original_dimensions,
                                                double const x_target, double const y_target) {
-  auto const width = static_cast<double>(original_dimensions.width);
-  auto const height = static_cast<double>(original_dimensions.height);
-
-  int const x_l = static_cast<int>(std::floor(x_target));
-  int x_h = static_cast<int>(std::ceil(x_target));
-  int const y_l = static_cast<int>(std::floor(y_target));
-  int y_h = static_cast<int>(std::ceil(y_target));
-  if (x_h >= static_cast<int>(width)) { x_h = x_l; }
-  if (y_h >= static_cast<int>(height)) { y_h = y_l; }
-  auto const index_xl_yl = static_cast<size_t>(
-    calculatePosition(Point{.x_coord = x_l, .y_coord = y_l}, original_dimensions));
-  auto const index_xh_yl = static_cast<size_t>(
-    calculatePosition(Point{.x_coord = x_h, .y_coord = y_l}, original_dimensions));
-  auto const index_xl_yh = static_cast<size_t>(
-    calculatePosition(Point{.x_coord = x_l, .y_coord = y_h}, original_dimensions));
-  auto const index_xh_yh = static_cast<size_t>(
-    calculatePosition(Point{.x_coord = x_h, .y_coord = y_h}, original_dimensions));
-  int const value_xl_yl = channel[index_xl_yl];
-  int const value_xh_yl = channel[index_xh_yl];
-  int const value_xl_yh = channel[index_xl_yh];
-  int const value_xh_yh = channel[index_xh_yh];
-  double weight_x = 0;
-  if (x_h - x_l != 0) { weight_x = (x_target - x_l) / (x_h - x_l); }
-  double const color1 = interpolate(value_xl_yl, value_xh_yl, weight_x);
-  double const color2 = interpolate(value_xl_yh, value_xh_yh, weight_x);
-  double weight_y = 0;
-  if (y_h - y_l != 0) { weight_y = (y_target - y_l) / (y_h - y_l); }
-  double const interpolated_pixel = interpolate(color1, color2, weight_y);
-  return interpolated_pixel;
+  auto const fetch = [&channel, original_dimensions](int const x_coord, int const y_coord) -> int {
+    return channel[static_cast<size_t>(
+      calculatePosition(Point{.x_coord = x_coord, .y_coord = y_coord}, original_dimensions))];
+  };
+  return bilinearAt(fetch, original_dimensions, x_target, y_target);
 }
 
 std::vector<uint8_t> ImageSOA_8bit::resize_helper(std::vector<uint8_t> & channel,
                                                   Dimensions const dim) const {
-  auto const new_width = static_cast<double>(dim.width);
-  auto const new_height = static_cast<double>(dim.height);
-  auto const original_dimensions = Dimensions{.width = gWidth(), .height = gHeight()};
-  auto const width = static_cast<double>(original_dimensions.width);
-  auto const height = static_cast<double>(original_dimensions.height);
-  auto const new_size = static_cast<size_t>(new_width * new_height);
-  std::vector<uint8_t> new_channel(new_size);
-  double const width_div = ((width - 1) / (new_width - 1));
-  double const height_div = ((height - 1) / (new_height - 1));
-  for (size_t new_y = 0; new_y < static_cast<size_t>(new_height); new_y++) {
-    for (size_t new_x = 0; new_x < static_cast<size_t>(new_width); new_x++) {
-      double const x_target = static_cast<double>(new_x) * width_div;
-
-      double const y_target = (static_cast<double>(new_y) * height_div);
-      double interpolated_pixel = 0;
-      if (std::floor(x_target) != x_target || std::floor(y_target) != y_target) {
-        interpolated_pixel =
-            helper_resizeInterpolate(channel, original_dimensions, x_target, y_target);
-      } else {
-        interpolated_pixel = channel[static_cast<size_t>(calculatePosition(
-            Point{.x_coord = static_cast<int>(x_target), .y_coord = static_cast<int>(y_target)},
-            original_dimensions))];
-      }
-      auto const new_point =
-          Point{.x_coord = static_cast<int>(new_x), .y_coord = static_cast<int>(new_y)};
-      auto const final_index = static_cast<size_t>(calculatePosition(new_point, dim));
-      new_channel[final_index] = static_cast<uint8_t>(std::round(interpolated_pixel));
-    }
-  }
+  std::vector<uint8_t> new_channel = ChannelBuffers<uint8_t>::acquire(dim.width * dim.height);
+  ResizeJob<uint8_t, 1> const job = {.sources  = {&channel},
+                                     .outputs  = {&new_channel},
+                                     .geometry = cornerGeometry(sizeOf(*this), dim),
+                                     .dim      = dim};
+  resizeChannels(*this, job, toSample8);
   return new_channel;
 }
 
@@ -500,91 +835,81 @@ int ImageSOA_16bit::calculatePosition(Point const point, Dimensions dim) {
 
 void ImageSOA_16bit::resize(Dimensions const dim) {
   std::cout << dim.width << "   " << dim.height << '\n';
-  // Replace the old channels with the new resized ones
-  red = resize_helper(red, dim);
-  green = resize_helper(green, dim);
-  blue = resize_helper(blue, dim);
+  // The resized channels replace the old ones, whose buffers go back to the cache with result
+  ImageSOA_16bit result = resized(dim);
+  std::swap(red, result.red);
+  std::swap(green, result.green);
+  std::swap(blue, result.blue);
   sWidth(dim.width);
   sHeight(dim.height);
 }
 
+ImageSOA_16bit ImageSOA_16bit::resized(Dimensions const dim) const {
+  // One pass over the output for the three channels
+  PPMMetadata const metadata = {.magicNumber   = gMagicNumber(),
+                                .width         = dim.width,
+                                .height        = dim.height,
+                                .maxColorValue = gMaxColorValue()};
+  ResizeJob<uint16_t, 3> const job = {.sources  = {&red, &green, &blue},
+                                      .outputs  = {},
+                                      .geometry = stepGeometry(sizeOf(*this), dim),
+                                      .dim      = dim};
+  ImageSOA_16bit result(metadata, resizedChannels(*this, job, lowByte));
+  result.sSettingsOf(*this);
+  return result;
+}
+
+void streamResize(StreamJob const & job, Dimensions const dim) {
+  std::cout << dim.width << "   " << dim.height << '\n';
+  std::ifstream input(job.input, std::ios::binary);
+  if (!input.is_open()) { throw std::runtime_error("Failed to open the file: " + job.input); }
+  ResizeStream const stream = {
+    .input = input, .header = readPPMHeader(input), .output = job.output};
+  // The header read may have hit the end of a tiny file; rows are read from payloadOffset on
+  input.clear();
+  input.seekg(static_cast<std::streamoff>(stream.header.payloadOffset));
+  Dimensions const source = {.width = stream.header.width, .height = stream.header.height};
+  if (stream.header.sampleBytes() == 1) {
+    streamResizeRows<uint8_t>(stream, cornerGeometry(source, dim), dim, toSample8);
+  } else {
+    streamResizeRows<uint16_t>(stream, stepGeometry(source, dim), dim, lowByte);
+  }
+}
+
 double ImageSOA_16bit::helper_resizeInterpolate(std::vector<uint16_t> & channel,
                                                 Dimensions const original_dimensions,
                                                 double const x_target, double const y_target) {
-  auto const width = static_cast<double>(original_dimensions.width);
-  auto const height = static_cast<double>(original_dimensions.height);
-
-  int const x_l = static_cast<int>(std::floor(x_target));
-  int x_h = static_cast<int>(std::ceil(x_target));
-  int const y_l = static_cast<int>(std::floor(y_target));
-  int y_h = static_cast<int>(std::ceil(y_target));
-  if (x_h >= static_cast<int>(width)) { x_h = x_l; }
-  if (y_h >= static_cast<int>(height)) { y_h = y_l; }
-  auto const index_xl_yl = static_cast<size_t>(
-    calculatePosition(Point{.x_coord = x_l, .y_coord = y_l}, original_dimensions));
-  auto const index_xh_yl = static_cast<size_t>(
-    calculatePosition(Point{.x_coord = x_h, .y_coord = y_l}, original_dimensions));
-  auto const index_xl_yh = static_cast<size_t>(
-    calculatePosition(Point{.x_coord = x_l, .y_coord = y_h}, original_dimensions));
-  auto const index_xh_yh = static_cast<size_t>(
-    calculatePosition(Point{.x_coord = x_h, .y_coord = y_h}, original_dimensions));
-  int const value_xl_yl = channel[index_xl_yl];
-  int const value_xh_yl = channel[index_xh_yl];
-  int const value_xl_yh = channel[index_xl_yh];
-  int const value_xh_yh = channel[index_xh_yh];
-  double weight_x = 0;
-  if (x_h - x_l != 0) { weight_x = (x_target - x_l) / (x_h - x_l); }
-  double const color1 = interpolate(value_xl_yl, value_xh_yl, weight_x);
-  double const color2 = interpolate(value_xl_yh, value_xh_yh, weight_x);
-  double weight_y = 0;
-  if (y_h - y_l != 0) { weight_y = (y_target - y_l) / (y_h - y_l); }
-  double const interpolated_pixel = interpolate(color1, color2, weight_y);
-  return interpolated_pixel;
+  auto const fetch = [&channel, original_dimensions](int const x_coord, int const y_coord) -> int {
+    return channel[static_cast<size_t>(
+      calculatePosition(Point{.x_coord = x_coord, .y_coord = y_coord}, original_dimensions))];
+  };
+  return bilinearAt(fetch, original_dimensions, x_target, y_target);
 }
 
 std::vector<uint16_t> ImageSOA_16bit::resize_helper(std::vector<uint16_t> & channel,
                                                     Dimensions const dim) const {
-  auto const new_width = static_cast<double>(dim.width);
-  auto const new_height = static_cast<double>(dim.height);
-  auto const original_dimensions = Dimensions{.width = gWidth(), .height = gHeight()};
-  auto const width = static_cast<double>(original_dimensions.width);
-  auto const height = static_cast<double>(original_dimensions.height);
-  auto const new_size = static_cast<size_t>(new_width * new_height);
-  std::vector<uint16_t> new_channel(new_size);
-  double const width_div = (width / new_width);
-  double const height_div = (height / new_height);
-  for (size_t new_y = 0; new_y < static_cast<size_t>(new_height); new_y++) {
-    for (size_t new_x = 0; new_x < static_cast<size_t>(new_width); new_x++) {
-      double const x_target = static_cast<double>(new_x) * width_div;
-
-      double const y_target = (static_cast<double>(new_y) * height_div);
-      double interpolated_pixel = 0;
-      if (std::floor(x_target) != x_target || std::floor(y_target) != y_target) {
-        interpolated_pixel =
-            helper_resizeInterpolate(channel, original_dimensions, x_target, y_target);
-      } else {
-        interpolated_pixel = channel[static_cast<size_t>(calculatePosition(
-            Point{.x_coord = static_cast<int>(x_target), .y_coord = static_cast<int>(y_target)},
-            original_dimensions))];
-      }
-      auto const new_point =
-          Point{.x_coord = static_cast<int>(new_x), .y_coord = static_cast<int>(new_y)};
-      auto const final_index = static_cast<size_t>(calculatePosition(new_point, dim));
-      new_channel[final_index] = static_cast<uint8_t>(std::round(interpolated_pixel));
-    }
-  }
+  std::vector<uint16_t> new_channel = ChannelBuffers<uint16_t>::acquire(dim.width * dim.height);
+  ResizeJob<uint16_t, 1> const job = {.sources  = {&channel},
+                                      .outputs  = {&new_channel},
+                                      .geometry = stepGeometry(sizeOf(*this), dim),
+                                      .dim      = dim};
+  resizeChannels(*this, job, lowByte);
   return new_channel;
 }
 
 void ImageSOA_8bit::reduceColors(size_t n) {
-  auto frequencies = computeColorFrequencies();
+  // Dense counts of the 2^24 colors; distinct colors are found by sweeping them
+  ColorHistogram const histogram(Planes8{.red = red, .green = green, .blue = blue});
 
   // If the number of colors to reduce is greater than or equal to the total number of colors,
   // return early
-  if (n >= frequencies.size()) { return; }
+  if (n >= histogram.distinctColors()) { return; }
 
   // Get the least frequent colors
-  auto colorsToRemove = findLeastFrequentColors(frequencies, n);
+  auto colorsToRemove = findLeastFrequentColors(histogram, n);
+
+  // Hashed counts, whose iteration order decides ties between equally near valid colors
+  auto const frequencies = computeColorFrequencies(histogram);
 
   // Create a set for valid colors
   std::unordered_set<RGB8> validColors;
@@ -594,34 +919,29 @@ void ImageSOA_8bit::reduceColors(size_t n) {
   for (auto const & color : colorsToRemove) { validColors.erase(color); }
 
   // Precompute nearest colors for the least frequent colors
-  std::unordered_map<RGB8, RGB8> replacementMap;
-  replacementMap.reserve(colorsToRemove.size()); // Reserve memory for efficiency
-
-  // Compute nearest colors and fill the replacement map
-  for (auto const & color : colorsToRemove) {
-    // Finding the closest color from the valid colors
-    RGB8 const closestColor = findNearestColor(color, validColors);
-    replacementMap[color] = closestColor;
-  }
+  std::unordered_map<RGB8, RGB8> const replacementMap =
+    findNearestColors(colorsToRemove, validColors);
 
   // Replace the colors in the image with the new mapped colors
   replaceColors(replacementMap);
 }
 
-std::unordered_map<RGB8, size_t> ImageSOA_8bit::computeColorFrequencies() const {
+std::unordered_map<RGB8, size_t>
+  ImageSOA_8bit::computeColorFrequencies(ColorHistogram const & histogram) const {
+  // One insert per color at its first pixel: the inserts of counting pixel by pixel into the
+  // map, in the same order, so the map iterates in the same order too
   std::unordered_map<RGB8, size_t> frequencies;
-  size_t const size = gWidth() * gHeight();
-
-  for (size_t i = 0; i < size; ++i) {
-    RGB8 const color{.r = red[i], .g = green[i], .b = blue[i]};
-    frequencies[color]++;
-  }
+  histogram.forEachFirstPixel(
+    gWidth() * gHeight(),
+    [this](size_t const i) { return ColorHistogram::indexOf(red[i], green[i], blue[i]); },
+    [&](size_t const i, uint64_t const count) {
+      frequencies.emplace(RGB8{.r = red[i], .g = green[i], .b = blue[i]}, count);
+    });
   return frequencies;
 }
 
-std::vector<RGB8>
-  ImageSOA_8bit::findLeastFrequentColors(std::unordered_map<RGB8, size_t> const & freqs,
-                                         size_t const n) {
+std::vector<RGB8> ImageSOA_8bit::findLeastFrequentColors(ColorHistogram const & histogram,
+                                                         size_t const n) {
   auto comp = [](std::pair<RGB8, size_t> const & var_a, std::pair<RGB8, size_t> const & var_b) {
     if (var_a.second != var_b.second) { return var_a.second < var_b.second; } // Change > to <
     if (var_a.first.b != var_b.first.b) { return var_a.first.b < var_b.first.b; }
@@ -632,10 +952,13 @@ std::vector<RGB8>
   std::priority_queue<std::pair<RGB8, size_t>, std::vector<std::pair<RGB8, size_t>>, decltype(comp)>
       priority_queue(comp);
 
-  for (auto const & [color, freq] : freqs) {
+  histogram.forEachColor([&](uint32_t const index, uint64_t const freq) {
+    RGB8 const color = {.r = static_cast<uint8_t>(index >> dieciseis),
+                        .g = static_cast<uint8_t>(index >> ocho),
+                        .b = static_cast<uint8_t>(index)};
     priority_queue.emplace(color, freq);
     if (priority_queue.size() > n) { priority_queue.pop(); }
-  }
+  });
 
   std::vector<RGB8> result;
   while (!priority_queue.empty()) {
@@ -645,40 +968,28 @@ std::vector<RGB8>
   return result;
 }
 
-double ImageSOA_8bit::colorDistance(const RGB8 & var_c1, const RGB8 & var_c2) {
-  double const var_dr = var_c1.r - var_c2.r;
-  double const var_dg = var_c1.g - var_c2.g;
-  double const var_db = var_c1.b - var_c2.b;
-  return (var_dr * var_dr) + (var_dg * var_dg) + (var_db * var_db);
-}
-
-RGB8 ImageSOA_8bit::findNearestColor(const RGB8 & target,
-                                     std::unordered_set<RGB8> const & validColors) {
-  // Initialize nearest color and minimum distance with the first color
-  RGB8 nearest = *validColors.begin();
-  double minDist = colorDistance(target, nearest);
-
-  // Loop through each valid color and find the nearest color
-  for (auto const & color : validColors) {
-    double const dist = colorDistance(target, color);
-    if (dist < minDist) {
-      minDist = dist;
-      nearest = color;
-    }
-  }
-  return nearest;
+std::unordered_map<RGB8, RGB8>
+  ImageSOA_8bit::findNearestColors(std::vector<RGB8> const & targets,
+                                    std::unordered_set<RGB8> const & validColors) {
+  return nearestColors(targets, std::vector<RGB8>(validColors.begin(), validColors.end()));
 }
 
 void ImageSOA_8bit::replaceColors(std::unordered_map<RGB8, RGB8> const & colorMap) {
-  size_t const size = gWidth() * gHeight();
-  for (size_t i = 0; i < size; ++i) {
-    RGB8 const color{.r = red[i], .g = green[i], .b = blue[i]};
-    if (auto found_color = colorMap.find(color); found_color != colorMap.end()) {
-      red[i] = found_color->second.r;
-      green[i] = found_color->second.g;
-      blue[i] = found_color->second.b;
+  // The vector kernel skips pixels whose color is not replaced; only the rest do a map lookup
+  ColorMarks marks;
+  for (auto const & [color, replacement] : colorMap) { marks.mark(color.r, color.g, color.b); }
+  forEachRun(*this, [&](size_t const begin, size_t const end) {
+    Planes8 const planes = {.red   = std::span(red).first(end),
+                            .green = std::span(green).first(end),
+                            .blue  = std::span(blue).first(end)};
+    for (size_t i = nextMarkedPixel(planes, marks, begin); i < end;
+         i = nextMarkedPixel(planes, marks, i + 1)) {
+      RGB8 const & replacement = colorMap.at(RGB8{.r = red[i], .g = green[i], .b = blue[i]});
+      red[i] = replacement.r;
+      green[i] = replacement.g;
+      blue[i] = replacement.b;
     }
-  }
+  });
 }
 
 // 16-bit implementations follow the same pattern
@@ -691,10 +1002,8 @@ void ImageSOA_16bit::reduceColors(size_t n) {
   for (auto const & [color, freq] : frequencies) { validColors.insert(color); }
   for (auto const & color : colorsToRemove) { validColors.erase(color); }
 
-  std::unordered_map<RGB16, RGB16> replacementMap;
-  for (auto const & color : colorsToRemove) {
-    replacementMap[color] = findNearestColor(color, validColors);
-  }
+  std::unordered_map<RGB16, RGB16> const replacementMap =
+    findNearestColors(colorsToRemove, validColors);
 
   replaceColors(replacementMap);
 }
@@ -737,36 +1046,21 @@ std::vector<RGB16>
   return result;
 }
 
-double ImageSOA_16bit::colorDistance(const RGB16 & var_c1, const RGB16 & var_c2) {
-  double const var_dr = var_c1.r - var_c2.r;
-  double const var_dg = var_c1.g - var_c2.g;
-  double const var_db = var_c1.b - var_c2.b;
-  return (var_dr * var_dr) + (var_dg * var_dg) + (var_db * var_db);
-}
-
-RGB16 ImageSOA_16bit::findNearestColor(const RGB16 & target,
-                                       std::unordered_set<RGB16> const & validColors) {
-  RGB16 nearest = *validColors.begin();
-  double minDist = colorDistance(target, nearest);
-
-  for (auto const & color : validColors) {
-    if (double const dist = colorDistance(target, color); dist < minDist) {
-      minDist = dist;
-      nearest = color;
-    }
-  }
-  return nearest;
+std::unordered_map<RGB16, RGB16>
+  ImageSOA_16bit::findNearestColors(std::vector<RGB16> const & targets,
+                                     std::unordered_set<RGB16> const & validColors) {
+  return nearestColors(targets, std::vector<RGB16>(validColors.begin(), validColors.end()));
 }
 
 void ImageSOA_16bit::replaceColors(std::unordered_map<RGB16, RGB16> const & colorMap) {
-  size_t const size = gWidth() * gHeight();
-  for (size_t i = 0; i < size; ++i) {
-    RGB16 const color{.r = red[i], .g = green[i], .b = blue[i]};
-    auto found_color = colorMap.find(color);
-    if (found_color != colorMap.end()) {
-      red[i] = found_color->second.r;
-      green[i] = found_color->second.g;
-      blue[i] = found_color->second.b;
+  forEachRun(*this, [&](size_t const begin, size_t const end) {
+    for (size_t i = begin; i < end; ++i) {
+      RGB16 const color{.r = red[i], .g = green[i], .b = blue[i]};
+      if (auto found_color = colorMap.find(color); found_color != colorMap.end()) {
+        red[i] = found_color->second.r;
+        green[i] = found_color->second.g;
+        blue[i] = found_color->second.b;
+      }
     }
-  }
+  });
 }
\ No newline at end of file
@@ -5,11 +5,19 @@
 #ifndef IMAGESOA_HPP
 #define IMAGESOA_HPP
 
+#include "common/binaryio.hpp"
+#include "common/colorhistogram.hpp"
+#include "common/palette.hpp"
+#include "common/ppmstream.hpp"
+#include "common/resample.hpp"
+#include "tiledchannel.hpp"
+
 #include <cstdint>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 constexpr uint8_t MAX_8BIT_VALUE = 255;
@@ -24,7 +32,10 @@ struct PPMMetadata {
   uint maxColorValue = 0;
 };
 
+// Only the header is read; no pixel data is touched
 PPMMetadata loadMetadata(std::string const & filepath);
+PPMMetadata loadMetadata(PPMHeader const & header);
+PPMMetadata loadMetadata(CompressedFile const & file);
 
 int numberInXbitRange(uint number);
 
@@ -77,6 +88,49 @@ namespace std {
   };
 } // namespace std
 
+// Per-thread free list of channel buffers. Images hand their channels back here when destroyed
+// and the next image built on the same thread takes them again, so a worker running many jobs
+// (batch mode) stops paying for fresh allocations and page faults on every image.
+template <typename Sample>
+class ChannelBuffers {
+  public:
+    // A zero-filled channel of size samples, reusing a cached allocation when there is one
+    static std::vector<Sample> acquire(size_t const size) {
+      auto & cache = freeList();
+      if (cache.empty()) { return std::vector<Sample>(size); }
+      std::vector<Sample> buffer = std::move(cache.back());
+      cache.pop_back();
+      buffer.assign(size, Sample{});
+      return buffer;
+    }
+
+    static void release(std::vector<Sample> && buffer) {
+      auto & cache = freeList();
+      if (buffer.capacity() == 0 || cache.size() >= maxCached) { return; }
+      cache.push_back(std::move(buffer));
+    }
+
+  private:
+    // Enough for the source and destination channels of one operation
+    static constexpr size_t maxCached = 6;
+
+    static std::vector<std::vector<Sample>> & freeList() {
+      thread_local std::vector<std::vector<Sample>> cache;
+      return cache;
+    }
+};
+
+// Order resize and cutfreq walk the channels in. Channels are always exposed row-major; with the
+// tiled layout resize reads its source through a TiledChannel copy and writes the result tile by
+// tile, which keeps the four bilinear neighbours of a whole output tile in a few cache lines.
+enum class ChannelLayout : uint8_t { rowMajor, tiled };
+
+// Arithmetic of resize. exact interpolates in double; fixedPoint runs the fixed-point kernels of
+// common/simdkernels.hpp, within 1 (8-bit) or 2 (16-bit) of the exact interpolated value, and
+// always reads the channels row-major. Both apply to the bilinear filter only; the other
+// filters of common/resample.hpp read the channels row-major and keep full samples.
+enum class ResizePrecision : uint8_t { exact, fixedPoint };
+
 class ImageSOA_8bit;
 class ImageSOA_16bit;
 
@@ -116,23 +170,68 @@ class ImageSOA {
 
     [[nodiscard]] std::string const & gMagicNumber() const { return magicNumber; }
 
+    void sLayout(ChannelLayout const newLayout) { layout = newLayout; }
+
+    [[nodiscard]] ChannelLayout gLayout() const { return layout; }
+
+    void sResizePrecision(ResizePrecision const newPrecision) { resizePrecision = newPrecision; }
+
+    [[nodiscard]] ResizePrecision gResizePrecision() const { return resizePrecision; }
+
+    void sResizeFilter(ResizeFilter const newFilter) { resizeFilter = newFilter; }
+
+    [[nodiscard]] ResizeFilter gResizeFilter() const { return resizeFilter; }
+
+    // Layout, resize precision and filter of other
+    void sSettingsOf(ImageSOA const & other) {
+      layout          = other.layout;
+      resizePrecision = other.resizePrecision;
+      resizeFilter    = other.resizeFilter;
+    }
+
   private:
     std::string magicNumber;
     size_t width;
     size_t height;
     uint maxColorValue;
+    ChannelLayout layout = ChannelLayout::rowMajor;
+    ResizePrecision resizePrecision = ResizePrecision::exact;
+    ResizeFilter resizeFilter = ResizeFilter::bilinear;
 };
 
 class ImageSOA_8bit final : public ImageSOA {
   public:
     explicit ImageSOA_8bit(PPMMetadata const & metadata)
-      : ImageSOA(metadata), red(gWidth() * gHeight()), green(gWidth() * gHeight()),
-        blue(gWidth() * gHeight()) {}
+      : ImageSOA(metadata), red(ChannelBuffers<uint8_t>::acquire(gWidth() * gHeight())),
+        green(ChannelBuffers<uint8_t>::acquire(gWidth() * gHeight())),
+        blue(ChannelBuffers<uint8_t>::acquire(gWidth() * gHeight())) {}
+
+    // Adopt already filled red, green and blue channels of width * height samples
+    ImageSOA_8bit(PPMMetadata const & metadata, std::array<std::vector<uint8_t>, 3> && channels)
+      : ImageSOA(metadata), red(std::move(channels[0])), green(std::move(channels[1])),
+        blue(std::move(channels[2])) {}
+
+    ImageSOA_8bit(ImageSOA_8bit const &)             = delete;
+    ImageSOA_8bit & operator=(ImageSOA_8bit const &) = delete;
+    ImageSOA_8bit(ImageSOA_8bit &&)                  = default;
+    ImageSOA_8bit & operator=(ImageSOA_8bit &&)      = default;
+
+    ~ImageSOA_8bit() override {
+      ChannelBuffers<uint8_t>::release(std::move(red));
+      ChannelBuffers<uint8_t>::release(std::move(green));
+      ChannelBuffers<uint8_t>::release(std::move(blue));
+    }
 
     bool operator==(ImageSOA_8bit const & other) const;
 
     void loadData(std::string const & filepath);
+    // Load from an already opened file, reusing its parsed header
+    void loadData(PPMFile const & file);
+    // Load straight from the compressed format, unpacking indices chunk by chunk
+    void loadData(CompressedFile const & file);
     void saveToFile(std::string const & filename);
+    // Write the image in the palette-indexed compressed format (see common/palette.hpp)
+    void compress(std::string const & filename) const;
 
     [[nodiscard]] std::vector<uint8_t> & gRed() { return red; }
 
@@ -142,8 +241,13 @@ class ImageSOA_8bit final : public ImageSOA {
 
     void maxLevel(uint newMax);
     [[nodiscard]] std::unique_ptr<ImageSOA_16bit> maxLevelChangeChannelSize(uint newMax);
+    // Same result as maxLevelChangeChannelSize, but consumes the image: each channel is freed as
+    // soon as its 16-bit copy is written, so only one extra channel is alive at a time
+    [[nodiscard]] ImageSOA_16bit toSixteenBit(uint newMax) &&;
     static int calculatePosition(Point point, Dimensions dim);
     void resize(Dimensions dim);
+    // A copy resized to dim with the same settings; this image is left untouched
+    [[nodiscard]] ImageSOA_8bit resized(Dimensions dim) const;
     static double helper_resizeInterpolate(std::vector<uint8_t> & channel,
                                            Dimensions original_dimensions, double x_target,
                                            double y_target);
@@ -154,25 +258,49 @@ class ImageSOA_8bit final : public ImageSOA {
     std::vector<uint8_t> red;
     std::vector<uint8_t> green;
     std::vector<uint8_t> blue;
-    [[nodiscard]] std::unordered_map<RGB8, size_t> computeColorFrequencies() const;
+    // Counts of histogram hashed by color, inserted in order of first pixel
+    [[nodiscard]] std::unordered_map<RGB8, size_t>
+      computeColorFrequencies(ColorHistogram const & histogram) const;
     [[nodiscard]] static std::vector<RGB8>
-      findLeastFrequentColors(std::unordered_map<RGB8, size_t> const & freqs, size_t n);
-    [[nodiscard]] static RGB8 findNearestColor(const RGB8 & target,
-                                               std::unordered_set<RGB8> const & validColors);
+      findLeastFrequentColors(ColorHistogram const & histogram, size_t n);
+    // Nearest valid color of every target; ties go to the first one in validColors' iteration
+    // order
+    [[nodiscard]] static std::unordered_map<RGB8, RGB8>
+      findNearestColors(std::vector<RGB8> const & targets,
+                        std::unordered_set<RGB8> const & validColors);
     void replaceColors(std::unordered_map<RGB8, RGB8> const & colorMap);
-    [[nodiscard]] static double colorDistance(const RGB8 & var_c1, const RGB8 & var_c2);
 };
 
 class ImageSOA_16bit final : public ImageSOA {
   public:
     explicit ImageSOA_16bit(PPMMetadata const & metadata)
-      : ImageSOA(metadata), red(gWidth() * gHeight()), green(gWidth() * gHeight()),
-        blue(gWidth() * gHeight()) {}
+      : ImageSOA(metadata), red(ChannelBuffers<uint16_t>::acquire(gWidth() * gHeight())),
+        green(ChannelBuffers<uint16_t>::acquire(gWidth() * gHeight())),
+        blue(ChannelBuffers<uint16_t>::acquire(gWidth() * gHeight())) {}
+
+    // Adopt already filled red, green and blue channels of width * height samples
+    ImageSOA_16bit(PPMMetadata const & metadata, std::array<std::vector<uint16_t>, 3> && channels)
+      : ImageSOA(metadata), red(std::move(channels[0])), green(std::move(channels[1])),
+        blue(std::move(channels[2])) {}
+
+    ImageSOA_16bit(ImageSOA_16bit const &)             = delete;
+    ImageSOA_16bit & operator=(ImageSOA_16bit const &) = delete;
+    ImageSOA_16bit(ImageSOA_16bit &&)                  = default;
+    ImageSOA_16bit & operator=(ImageSOA_16bit &&)      = default;
+
+    ~ImageSOA_16bit() override {
+      ChannelBuffers<uint16_t>::release(std::move(red));
+      ChannelBuffers<uint16_t>::release(std::move(green));
+      ChannelBuffers<uint16_t>::release(std::move(blue));
+    }
 
     bool operator==(ImageSOA_16bit const & other) const;
     void loadData(std::string const & filepath);
+    void loadData(PPMFile const & file);
+    void loadData(CompressedFile const & file);
     void saveToFileBE(std::string const & filename);
     void saveToFile(std::string const & filename);
+    void compress(std::string const & filename) const;
 
     [[nodiscard]] std::vector<uint16_t> & gRed() { return red; }
 
@@ -182,8 +310,13 @@ class ImageSOA_16bit final : public ImageSOA {
 
     void maxLevel(uint newMax);
     [[nodiscard]] std::unique_ptr<ImageSOA_8bit> maxLevelChangeChannelSize(uint newMax);
+    // Same result as maxLevelChangeChannelSize, but consumes the image: each channel is freed as
+    // soon as its 8-bit copy is written, so only one extra channel is alive at a time
+    [[nodiscard]] ImageSOA_8bit toEightBit(uint newMax) &&;
     static int calculatePosition(Point point, Dimensions dim);
     void resize(Dimensions dim);
+    // A copy resized to dim with the same settings; this image is left untouched
+    [[nodiscard]] ImageSOA_16bit resized(Dimensions dim) const;
     static double helper_resizeInterpolate(std::vector<uint16_t> & channel,
                                            Dimensions original_dimensions, double x_target,
                                            double y_target);
@@ -197,10 +330,18 @@ class ImageSOA_16bit final : public ImageSOA {
     [[nodiscard]] std::unordered_map<RGB16, size_t> computeColorFrequencies() const;
     [[nodiscard]] static std::vector<RGB16>
       findLeastFrequentColors(std::unordered_map<RGB16, size_t> const & freqs, size_t n);
-    [[nodiscard]] static RGB16 findNearestColor(const RGB16 & target,
-                                                std::unordered_set<RGB16> const & validColors);
+    // Nearest valid color of every target; ties go to the first one in validColors' iteration
+    // order
+    [[nodiscard]] static std::unordered_map<RGB16, RGB16>
+      findNearestColors(std::vector<RGB16> const & targets,
+                        std::unordered_set<RGB16> const & validColors);
     void replaceColors(std::unordered_map<RGB16, RGB16> const & colorMap);
-    [[nodiscard]] static double colorDistance(const RGB16 & var_c1, const RGB16 & var_c2);
 };
 
+// Bilinear resize of the PPM job.input into job.output without loading either image: source rows
+// are read on demand into a ring of two rows and every output row is written as soon as it is
+// computed, so memory grows with the width only. The output is the same as loading the image
+// and calling resize(dim) with the default filter and precision.
+void streamResize(StreamJob const & job, Dimensions dim);
+
 #endif  // IMAGESOA_HPP
\ No newline at end of file
@@ -0,0 +1,90 @@
+#ifndef TILEDCHANNEL_HPP
+#define TILEDCHANNEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Side of the square tiles. 64x64 8-bit samples (4 KiB) or 16-bit samples (8 KiB) keep a tile
+// and its neighbour well inside L1.
+constexpr size_t tileSize = 64;
+
+// Rectangle of an image covered by one tile; edge tiles are cut to the image size
+struct TileRegion {
+    size_t x      = 0;
+    size_t y      = 0;
+    size_t width  = 0;
+    size_t height = 0;
+};
+
+// Visit the tiles of rows [firstRow, endRow) of a width-wide image, tile rows top to bottom,
+// tiles left to right. firstRow is a multiple of tileSize; endRow too, or the image height.
+template <typename Visit>
+void forEachTileRegion(size_t const width, size_t const firstRow, size_t const endRow,
+                       Visit visit) {
+  for (size_t tileY = firstRow; tileY < endRow; tileY += tileSize) {
+    for (size_t tileX = 0; tileX < width; tileX += tileSize) {
+      visit(TileRegion{.x      = tileX,
+                       .y      = tileY,
+                       .width  = std::min(tileSize, width - tileX),
+                       .height = std::min(tileSize, endRow - tileY)});
+    }
+  }
+}
+
+// Visit every tile of a width x height image
+template <typename Visit>
+void forEachTileRegion(size_t const width, size_t const height, Visit visit) {
+  forEachTileRegion(width, 0, height, visit);
+}
+
+// One channel stored tile by tile: each 64x64 tile is contiguous and row-major inside, so samples
+// that are close in 2D are close in memory. Edge tiles are padded to the full tile size.
+template <typename Sample>
+class TiledChannel {
+  public:
+    TiledChannel(std::span<Sample const> const rowMajor, size_t const width, size_t const height)
+      : width(width), tilesAcross((width + tileSize - 1) / tileSize),
+        samples(tilesAcross * ((height + tileSize - 1) / tileSize) * tileSize * tileSize) {
+      forEachTileRegion(width, height, [&](TileRegion const & region) {
+        for (size_t row = 0; row < region.height; ++row) {
+          Sample const * source = &rowMajor[((region.y + row) * width) + region.x];
+          std::copy(source, source + region.width, &at(region.x, region.y + row));
+        }
+      });
+    }
+
+    [[nodiscard]] Sample const & at(size_t const x, size_t const y) const {
+      return samples[offset(x, y)];
+    }
+
+    Sample & at(size_t const x, size_t const y) { return samples[offset(x, y)]; }
+
+    // Position of (x, y) in the tile storage, the same for every channel of the same size
+    [[nodiscard]] size_t offset(size_t const x, size_t const y) const {
+      size_t const tile = ((y / tileSize) * tilesAcross) + (x / tileSize);
+      return (tile * tileSize * tileSize) + ((y % tileSize) * tileSize) + (x % tileSize);
+    }
+
+    [[nodiscard]] Sample const & atOffset(size_t const position) const { return samples[position]; }
+
+    // Copy back into a row-major channel of the original size
+    void toRowMajor(std::span<Sample> const rowMajor) const {
+      size_t const height = rowMajor.size() / width;
+      forEachTileRegion(width, height, [&](TileRegion const & region) {
+        for (size_t row = 0; row < region.height; ++row) {
+          Sample const * source = &at(region.x, region.y + row);
+          std::copy(source, source + region.width,
+                    &rowMajor[((region.y + row) * width) + region.x]);
+        }
+      });
+    }
+
+  private:
+    size_t width;
+    size_t tilesAcross;
+    std::vector<Sample> samples;
+};
+
+#endif //TILEDCHANNEL_HPP
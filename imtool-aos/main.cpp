@@ -1,9 +1,60 @@
 #include <iostream>
+#include <optional>
 #include <stdexcept>
+#include <type_traits>
+#include <variant>
+#include "../common/ppminfo.hpp"
 #include "../common/progargs.hpp"
 #include "../imgaos/imageaos.hpp"
 
 namespace {
+  PPMMetadata metadataOf(const PPMFile& file) { return getPPMMetadata(file.header()); }
+
+  PPMMetadata metadataOf(const CompressedFile& file) { return getPPMMetadata(file); }
+
+  // Abre un PPM binario o una imagen en formato comprimido según su número mágico
+  std::variant<PPMFile, CompressedFile> openInput(const std::string& filename) {
+    if (isCompressedFile(filename)) { return CompressedFile(filename); }
+    return PPMFile(filename);
+  }
+
+  constexpr int maxValor8Bits = 255;
+
+  // Imagen abierta una sola vez: los metadatos salen de la cabecera y los píxeles solo se
+  // decodifican la primera vez que una operación los pide, como Pixel8 si la imagen es de 8 bits
+  // y como Pixel16 si es de 16
+  class LazyImage {
+    public:
+      explicit LazyImage(const std::string& filename)
+        : file(openInput(filename)),
+          meta(std::visit([](const auto& opened) { return metadataOf(opened); }, file)) {}
+
+      [[nodiscard]] const PPMMetadata& metadata() const { return meta; }
+
+      // Llama a visit con los píxeles del tipo que corresponde a la profundidad de la imagen
+      template <typename Visit>
+      void visitPixels(const Visit& visit) {
+        if (meta.maxColorValue <= maxValor8Bits) {
+          visit(pixels<Pixel8>());
+        } else {
+          visit(pixels<Pixel16>());
+        }
+      }
+
+    private:
+      std::variant<PPMFile, CompressedFile> file;
+      PPMMetadata meta;
+      std::optional<std::variant<std::vector<Pixel8>, std::vector<Pixel16>>> decoded;
+
+      template <typename P>
+      std::vector<P>& pixels() {
+        if (!decoded) {
+          decoded = std::visit([](const auto& opened) { return loadImage<P>(opened); }, file);
+        }
+        return std::get<std::vector<P>>(*decoded);
+      }
+  };
+
   void printInfo(const std::string& inputFilename, const PPMMetadata& metadata) {
     std::cout << "Operación: info\n"
               << "Archivo de entrada: " << inputFilename << "\n"
@@ -13,34 +64,84 @@ namespace {
               << "Valor máximo de color: " << metadata.maxColorValue << '\n';
   }
 
-  void handleMaxLevel(std::vector<Pixel>& pixels, const ProgramArgs& args, const PPMMetadata& metadata) {
+  // Una línea por imagen (ruta, número mágico, ancho, alto, valor máximo), en el orden de entrada.
+  // Solo se leen las cabeceras, repartidas entre todos los hilos.
+  int printInfoBatch(const std::string& source) {
+    ThreadPool pool;
+    const std::vector<InfoEntry> entries = readInfoBatch(listInfoInputs(source), pool);
+    int status = 0;
+    for (const InfoEntry& entry : entries) {
+      if (!entry.error.empty()) {
+        std::cout << entry.path << '\t' << entry.error << '\n';
+        status = 1;
+        continue;
+      }
+      std::cout << entry.path << '\t' << entry.header.magicNumber << '\t' << entry.header.width
+                << '\t' << entry.header.height << '\t' << entry.header.maxColorValue << '\n';
+    }
+    return status;
+  }
+
+  void handleMaxLevel(LazyImage& image, const ProgramArgs& args) {
+    const PPMMetadata& metadata = image.metadata();
     const int maxLevel = std::stoi(args.extraParams[0]);
     std::cout << "Operación: maxlevel\nNuevo valor: " << maxLevel << '\n';
-    scaleIntensity(pixels, metadata.maxColorValue, maxLevel);
     const PPMMetadata newMetadata = {.magicNumber = metadata.magicNumber, .width = metadata.width, .height = metadata.height, .maxColorValue = maxLevel};
-    saveImage(args.outputFile, pixels, newMetadata);
+    image.visitPixels([&](auto& pixels) {
+      // Con la misma profundidad se escala en el sitio; si cambia, se pasa al otro tipo de píxel
+      using Entrada = std::remove_reference_t<decltype(pixels)>::value_type;
+      if ((maxLevel > maxValor8Bits) == std::is_same_v<Entrada, Pixel16>) {
+        scaleIntensity(pixels, metadata.maxColorValue, maxLevel);
+        saveImage(args.outputFile, pixels, newMetadata);
+      } else if (maxLevel > maxValor8Bits) {
+        saveImage(args.outputFile, scaleIntensityTo<Pixel16>(pixels, metadata.maxColorValue, maxLevel), newMetadata);
+      } else {
+        saveImage(args.outputFile, scaleIntensityTo<Pixel8>(pixels, metadata.maxColorValue, maxLevel), newMetadata);
+      }
+    });
   }
 
-  void handleResize(std::vector<Pixel>& pixels, const ProgramArgs& args, const PPMMetadata& metadata) {
+  void handleResize(LazyImage& image, const ProgramArgs& args) {
+    const PPMMetadata& metadata = image.metadata();
     const int newWidth = std::stoi(args.extraParams[0]);
     const int newHeight = std::stoi(args.extraParams[1]);
     std::cout << "Operación: resize\nAncho nuevo: " << newWidth
               << "\nAlto nuevo: " << newHeight << '\n';
     PPMMetadata const newMetadata = {.magicNumber = metadata.magicNumber, .width = newWidth, .height = newHeight, .maxColorValue = metadata.maxColorValue};
-    pixels = resizeImage(pixels, metadata, newWidth, newHeight);
-    saveImage(args.outputFile, pixels, newMetadata);
+    // Sin filtro, o con bilinear, se mantiene la interpolación bilineal de siempre
+    const ResizeFilter filter = args.extraParams.size() > 2 ? *resizeFilterNamed(args.extraParams[2]) : ResizeFilter::bilinear;
+    if (filter != ResizeFilter::bilinear) {
+        std::cout << "Filtro: " << args.extraParams[2] << '\n';
+        image.visitPixels([&](const auto& pixels) {
+          saveImage(args.outputFile, resampleImage(pixels, metadata, newMetadata, filter), newMetadata);
+        });
+        return;
+    }
+    image.visitPixels([&](const auto& pixels) {
+      saveImage(args.outputFile, resizeImage(pixels, metadata, newWidth, newHeight), newMetadata);
+    });
   }
 
-  void handleCutFreq(std::vector<Pixel>& pixels, const ProgramArgs& args, const PPMMetadata& metadata) {
+  void handleCutFreq(LazyImage& image, const ProgramArgs& args) {
+    const PPMMetadata& metadata = image.metadata();
     const int numColorsToRemove = std::stoi(args.extraParams[0]);
     std::cout << "Operación: cutfreq\nColores a eliminar: " << numColorsToRemove << '\n';
-    pixels = removeLeastFrequentColors(pixels, numColorsToRemove);
-    saveImage(args.outputFile, pixels, metadata);
+    image.visitPixels([&](const auto& pixels) {
+      saveImage(args.outputFile, removeLeastFrequentColors(pixels, numColorsToRemove), metadata);
+    });
   }
 
-  void handleCompress(const std::vector<Pixel>& pixels, const ProgramArgs& args, const PPMMetadata& metadata) {
+  void handleCompress(LazyImage& image, const ProgramArgs& args) {
+    const PPMMetadata& metadata = image.metadata();
     std::cout << "Operación: compress\n";
-    saveImage(args.outputFile, pixels, metadata);
+    image.visitPixels([&](const auto& pixels) { compressImage(args.outputFile, pixels, metadata); });
+  }
+
+  // Descomprime directamente al PPM de salida, sin construir la imagen intermedia
+  void handleDecompress(const ProgramArgs& args) {
+    std::cout << "Operación: decompress\n";
+    const CompressedFile file(args.inputFile);
+    decompressToPPM(file, args.outputFile);
   }
 }
 
@@ -52,21 +153,28 @@ int main(const int argc, char* argv[]) {
         // Procesar y validar argumentos usando processArgs
         const ProgramArgs args = processArgs(arguments);
 
-        // Cargar metadatos e imagen
-        const PPMMetadata metadata = getPPMMetadata(args.inputFile);
-        std::vector<Pixel> pixels = loadImage(args.inputFile, metadata);
-
-        // Ejecutar operación según el tipo en args.operation
+        // info solo necesita la cabecera: no se abre la imagen completa
         if (args.operation == "info") {
-            printInfo(args.inputFile, metadata);
-        } else if (args.operation == "maxlevel") {
-            handleMaxLevel(pixels, args, metadata);
+            if (isInfoBatchSource(args.inputFile)) { return printInfoBatch(args.inputFile); }
+            printInfo(args.inputFile, getPPMMetadata(args.inputFile));
+            return 0;
+        }
+
+        if (args.operation == "decompress") {
+            handleDecompress(args);
+            return 0;
+        }
+
+        // El resto de operaciones decodifica los píxeles al pedirlos (de un PPM o de un comprimido)
+        LazyImage image(args.inputFile);
+        if (args.operation == "maxlevel") {
+            handleMaxLevel(image, args);
         } else if (args.operation == "resize") {
-            handleResize(pixels, args, metadata);
+            handleResize(image, args);
         } else if (args.operation == "cutfreq") {
-            handleCutFreq(pixels, args, metadata);
+            handleCutFreq(image, args);
         } else if (args.operation == "compress") {
-            handleCompress(pixels, args, metadata);
+            handleCompress(image, args);
         } else {
             std::cerr << "Error: Operación desconocida.\n";
             return 1;
@@ -1,3 +1,126 @@
 //
 // Created by diego on 20/10/24.
 //
+
+#include "../common/binaryio.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+  std::vector<uint8_t> bytesOf(const std::string& text) {
+    return {text.begin(), text.end()};
+  }
+}
+
+// Test para la cabecera mínima: el payload empieza tras el único espacio después de maxval
+TEST(ParsePPMHeaderTest, PlainHeader) {
+    const std::vector<uint8_t> data = bytesOf("P6\n2 2\n255\nabcdefghijkl");
+    const PPMHeader header = parsePPMHeader(data);
+    EXPECT_EQ(header.magicNumber, "P6");
+    EXPECT_EQ(header.width, 2);
+    EXPECT_EQ(header.height, 2);
+    EXPECT_EQ(header.maxColorValue, 255);
+    EXPECT_EQ(header.payloadOffset, 11);
+    EXPECT_EQ(header.payloadBytes(), 12);
+}
+
+// Test para cabeceras con comentarios y espacios arbitrarios
+TEST(ParsePPMHeaderTest, CommentsAndWhitespace) {
+    const std::vector<uint8_t> data = bytesOf("P6 # comentario\n\t2  # otro\n 2\r\n65535 xyz");
+    const PPMHeader header = parsePPMHeader(data);
+    EXPECT_EQ(data[header.payloadOffset], 'x');
+    EXPECT_EQ(header.sampleBytes(), 2);
+}
+
+// Test para una cabecera truncada
+TEST(ParsePPMHeaderTest, TruncatedHeader) {
+    EXPECT_THROW(parsePPMHeader(bytesOf("P6\n2 2\n")), std::runtime_error);
+    EXPECT_THROW(parsePPMHeader(bytesOf("P6\n2 2\n255")), std::runtime_error);
+}
+
+// Test para cabeceras con valores inválidos
+TEST(ParsePPMHeaderTest, InvalidValues) {
+    EXPECT_THROW(parsePPMHeader(bytesOf("P3\n2 2\n255\n")), std::runtime_error);
+    EXPECT_THROW(parsePPMHeader(bytesOf("P6\n0 2\n255\n")), std::runtime_error);
+    EXPECT_THROW(parsePPMHeader(bytesOf("P6\n2 x\n255\n")), std::runtime_error);
+    EXPECT_THROW(parsePPMHeader(bytesOf("P6\n2 2\n65536\n")), std::runtime_error);
+}
+
+// Test para separar canales de 8 bits (cubre el camino vectorial y la cola escalar)
+TEST(DeinterleaveTest, EightBitChannels) {
+    constexpr size_t pixels = 37;
+    std::vector<uint8_t> src(pixels * 3);
+    for (size_t i = 0; i < src.size(); ++i) { src[i] = static_cast<uint8_t>(i * 7); }
+    std::vector<uint8_t> red(pixels);
+    std::vector<uint8_t> green(pixels);
+    std::vector<uint8_t> blue(pixels);
+    deinterleave8(src, red, green, blue);
+    for (size_t i = 0; i < pixels; ++i) {
+        EXPECT_EQ(red[i], src[i * 3]);
+        EXPECT_EQ(green[i], src[(i * 3) + 1]);
+        EXPECT_EQ(blue[i], src[(i * 3) + 2]);
+    }
+}
+
+// Test para separar canales de 16 bits almacenados en big-endian
+TEST(DeinterleaveTest, SixteenBitBigEndianChannels) {
+    constexpr size_t pixels = 21;
+    std::vector<uint8_t> src(pixels * 6);
+    for (size_t i = 0; i < src.size(); ++i) { src[i] = static_cast<uint8_t>((i * 13) + 1); }
+    std::vector<uint16_t> red(pixels);
+    std::vector<uint16_t> green(pixels);
+    std::vector<uint16_t> blue(pixels);
+    deinterleave16BE(src, red, green, blue);
+    auto const sample = [&src](size_t offset) {
+        return static_cast<uint16_t>((src[offset] << 8U) | src[offset + 1]);
+    };
+    for (size_t i = 0; i < pixels; ++i) {
+        EXPECT_EQ(red[i], sample(i * 6));
+        EXPECT_EQ(green[i], sample((i * 6) + 2));
+        EXPECT_EQ(blue[i], sample((i * 6) + 4));
+    }
+}
+
+// Test para intercalar canales de 8 bits (inverso de deinterleave8)
+TEST(InterleaveTest, EightBitRoundTrip) {
+    constexpr size_t pixels = 53;
+    std::vector<uint8_t> src(pixels * 3);
+    for (size_t i = 0; i < src.size(); ++i) { src[i] = static_cast<uint8_t>((i * 31) + 5); }
+    std::vector<uint8_t> red(pixels);
+    std::vector<uint8_t> green(pixels);
+    std::vector<uint8_t> blue(pixels);
+    deinterleave8(src, red, green, blue);
+    std::vector<uint8_t> dst(src.size());
+    interleave8(red, green, blue, dst);
+    EXPECT_EQ(dst, src);
+}
+
+// Test para intercalar canales de 16 bits en ambos órdenes de bytes
+TEST(InterleaveTest, SixteenBitByteOrder) {
+    constexpr size_t pixels = 19;
+    std::vector<uint16_t> red(pixels);
+    std::vector<uint16_t> green(pixels);
+    std::vector<uint16_t> blue(pixels);
+    for (size_t i = 0; i < pixels; ++i) {
+        red[i] = static_cast<uint16_t>((i * 4099) + 1);
+        green[i] = static_cast<uint16_t>((i * 257) + 2);
+        blue[i] = static_cast<uint16_t>((i * 60013) + 3);
+    }
+    std::vector<uint8_t> bigEndian(pixels * 6);
+    std::vector<uint8_t> littleEndian(pixels * 6);
+    interleave16BE(red, green, blue, bigEndian);
+    interleave16LE(red, green, blue, littleEndian);
+    for (size_t i = 0; i < bigEndian.size(); i += 2) {
+        EXPECT_EQ(bigEndian[i], littleEndian[i + 1]);
+        EXPECT_EQ(bigEndian[i + 1], littleEndian[i]);
+    }
+    std::vector<uint16_t> red2(pixels);
+    std::vector<uint16_t> green2(pixels);
+    std::vector<uint16_t> blue2(pixels);
+    deinterleave16BE(bigEndian, red2, green2, blue2);
+    EXPECT_EQ(red2, red);
+    EXPECT_EQ(green2, green);
+    EXPECT_EQ(blue2, blue);
+}
@@ -0,0 +1,92 @@
+#include "../common/colorhistogram.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace {
+  // Planos con pocos colores repetidos en rachas, como una foto con zonas planas
+  struct Planos {
+      std::vector<uint8_t> red;
+      std::vector<uint8_t> green;
+      std::vector<uint8_t> blue;
+  };
+
+  Planos planosAleatorios(size_t pixels, uint32_t seed) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> sample(0, 15);
+    std::uniform_int_distribution<int> run(1, 8);
+    Planos planos;
+    while (planos.red.size() < pixels) {
+      const auto red = static_cast<uint8_t>(sample(generator) * 17);
+      const auto green = static_cast<uint8_t>(sample(generator));
+      const auto blue = static_cast<uint8_t>(sample(generator) * 16);
+      for (int i = run(generator); i > 0 && planos.red.size() < pixels; --i) {
+        planos.red.push_back(red);
+        planos.green.push_back(green);
+        planos.blue.push_back(blue);
+      }
+    }
+    return planos;
+  }
+
+  std::map<uint32_t, uint64_t> cuentasDe(Planos const & planos) {
+    std::map<uint32_t, uint64_t> cuentas;
+    for (size_t i = 0; i < planos.red.size(); ++i) {
+      ++cuentas[ColorHistogram::indexOf(planos.red[i], planos.green[i], planos.blue[i])];
+    }
+    return cuentas;
+  }
+}
+
+// Test para ColorHistogram: mismas cuentas que un mapa, también con varios histogramas parciales
+TEST(ColorHistogramTest, CountsMatchMap) {
+    for (const size_t pixels : {size_t{1}, size_t{1000}, size_t{9'000'001}}) {
+        const Planos planos = planosAleatorios(pixels, 5);
+        const ColorHistogram histogram(Planes8{.red = planos.red, .green = planos.green, .blue = planos.blue});
+        const auto cuentas = cuentasDe(planos);
+        std::vector<std::pair<uint32_t, uint64_t>> visitados;
+        histogram.forEachColor([&](uint32_t index, uint64_t count) { visitados.emplace_back(index, count); });
+        EXPECT_EQ(visitados, (std::vector<std::pair<uint32_t, uint64_t>>(cuentas.begin(), cuentas.end())));
+        EXPECT_EQ(histogram.distinctColors(), cuentas.size());
+    }
+}
+
+// Test para píxeles intercalados: el mismo histograma que con planos
+TEST(ColorHistogramTest, InterleavedMatchesPlanes) {
+    const Planos planos = planosAleatorios(20'000, 7);
+    std::vector<uint8_t> intercalados;
+    for (size_t i = 0; i < planos.red.size(); ++i) {
+        intercalados.insert(intercalados.end(), {planos.red[i], planos.green[i], planos.blue[i]});
+    }
+    const ColorHistogram porPlanos(Planes8{.red = planos.red, .green = planos.green, .blue = planos.blue});
+    const ColorHistogram porPixeles{std::span<const uint8_t>(intercalados)};
+    for (const auto& [index, count] : cuentasDe(planos)) {
+        EXPECT_EQ(porPixeles.count(index), count);
+        EXPECT_EQ(porPlanos.count(index), count);
+    }
+}
+
+// Test para forEachFirstPixel: un píxel por color, el primero de cada uno y en orden
+TEST(ColorHistogramTest, VisitsFirstPixelOfEachColor) {
+    const Planos planos = planosAleatorios(50'000, 9);
+    const ColorHistogram histogram(Planes8{.red = planos.red, .green = planos.green, .blue = planos.blue});
+    const auto indexAt = [&](size_t i) { return ColorHistogram::indexOf(planos.red[i], planos.green[i], planos.blue[i]); };
+    std::vector<size_t> esperados;
+    std::map<uint32_t, bool> vistos;
+    for (size_t i = 0; i < planos.red.size(); ++i) {
+        if (!vistos[indexAt(i)]) {
+            vistos[indexAt(i)] = true;
+            esperados.push_back(i);
+        }
+    }
+    std::vector<size_t> visitados;
+    histogram.forEachFirstPixel(planos.red.size(), indexAt, [&](size_t pixel, uint64_t count) {
+        visitados.push_back(pixel);
+        EXPECT_EQ(count, histogram.count(indexAt(pixel)));
+    });
+    EXPECT_EQ(visitados, esperados);
+}
@@ -0,0 +1,42 @@
+#include "../common/colortree.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+  // Recorrido lineal de referencia: se queda con el primer color estrictamente más cercano
+  size_t linearNearest(std::vector<ColorKey> const & colors, ColorKey const & target) {
+    size_t nearest = 0;
+    uint64_t best = UINT64_MAX;
+    for (size_t i = 0; i < colors.size(); ++i) {
+      uint64_t distance = 0;
+      for (size_t axis = 0; axis < 3; ++axis) {
+        const int64_t difference = static_cast<int64_t>(colors[i][axis]) - target[axis];
+        distance += static_cast<uint64_t>(difference * difference);
+      }
+      if (distance < best) {
+        best = distance;
+        nearest = i;
+      }
+    }
+    return nearest;
+  }
+}
+
+// Test para ColorTree: mismo color que el recorrido lineal, también con muchos empates y repetidos
+TEST(ColorTreeTest, MatchesLinearScan) {
+    std::mt19937 generator(11);
+    for (const uint16_t maxValue : {uint16_t{3}, uint16_t{40}, uint16_t{255}, uint16_t{65535}}) {
+        std::uniform_int_distribution<uint16_t> sample(0, maxValue);
+        for (const size_t size : {1UL, 2UL, 7UL, 300UL}) {
+            std::vector<ColorKey> colors(size);
+            for (auto& color : colors) { color = {sample(generator), sample(generator), sample(generator)}; }
+            const ColorTree tree(colors);
+            for (int query = 0; query < 200; ++query) {
+                const ColorKey target = {sample(generator), sample(generator), sample(generator)};
+                EXPECT_EQ(tree.nearest(target), linearNearest(colors, target)) << maxValue << ' ' << size;
+            }
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#include "../imgsoa/imagesoa.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <utility>
+
+namespace {
+  constexpr size_t width = 97;
+  constexpr size_t height = 41;
+
+  // Imagen de 8 bits con valores distintos en cada canal
+  ImageSOA_8bit image8() {
+    ImageSOA_8bit image(
+      PPMMetadata{.magicNumber = "P6", .width = width, .height = height, .maxColorValue = 255});
+    for (size_t i = 0; i < width * height; ++i) {
+      image.gRed()[i] = static_cast<uint8_t>(i % 256);
+      image.gGreen()[i] = static_cast<uint8_t>((i * 7) % 256);
+      image.gBlue()[i] = static_cast<uint8_t>(255 - (i % 256));
+    }
+    return image;
+  }
+
+  // Imagen de 16 bits con valores distintos en cada canal
+  ImageSOA_16bit image16() {
+    ImageSOA_16bit image(
+      PPMMetadata{.magicNumber = "P6", .width = width, .height = height, .maxColorValue = 65535});
+    for (size_t i = 0; i < width * height; ++i) {
+      image.gRed()[i] = static_cast<uint16_t>(i * 13);
+      image.gGreen()[i] = static_cast<uint16_t>(65535 - i);
+      image.gBlue()[i] = static_cast<uint16_t>((i * 541) % 65536);
+    }
+    return image;
+  }
+}
+
+// Test para la conversión de 8 a 16 bits: mismo resultado que maxLevelChangeChannelSize
+TEST(DepthConversionTest, EightToSixteenMatchesCopy) {
+    ImageSOA_8bit source = image8();
+    auto const expected = image8().maxLevelChangeChannelSize(1000);
+    ImageSOA_16bit converted = std::move(source).toSixteenBit(1000);
+    EXPECT_EQ(converted.gMaxColorValue(), 1000);
+    EXPECT_EQ(converted.gWidth(), width);
+    EXPECT_EQ(converted.gHeight(), height);
+    EXPECT_EQ(converted.gRed(), expected->gRed());
+    EXPECT_EQ(converted.gGreen(), expected->gGreen());
+    EXPECT_EQ(converted.gBlue(), expected->gBlue());
+    EXPECT_TRUE(source.gRed().empty());
+}
+
+// Test para la conversión de 16 a 8 bits: mismo resultado que maxLevelChangeChannelSize
+TEST(DepthConversionTest, SixteenToEightMatchesCopy) {
+    ImageSOA_16bit source = image16();
+    auto const expected = image16().maxLevelChangeChannelSize(200);
+    ImageSOA_8bit converted = std::move(source).toEightBit(200);
+    EXPECT_EQ(converted.gMaxColorValue(), 200);
+    EXPECT_EQ(converted.gRed(), expected->gRed());
+    EXPECT_EQ(converted.gGreen(), expected->gGreen());
+    EXPECT_EQ(converted.gBlue(), expected->gBlue());
+    EXPECT_TRUE(source.gBlue().empty());
+}
@@ -0,0 +1,28 @@
+#include "../common/leveltable.hpp"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Test para la tabla de maxlevel: cada entrada coincide con el cálculo en coma flotante por muestra
+TEST(LevelTableTest, MatchesPerSampleRounding) {
+    for (const uint currentMax : {255U, 100U, 65535U, 1000U}) {
+        for (const uint newMax : {1U, 128U, 255U, 256U, 40000U, 65535U}) {
+            const auto table = maxLevelTable<uint16_t, uint>(currentMax, newMax);
+            const float scale = static_cast<float>(newMax) / static_cast<float>(currentMax);
+            for (uint value = 0; value <= currentMax; ++value) {
+                ASSERT_EQ(table[value], static_cast<uint>(std::floor(static_cast<float>(value) * scale)));
+            }
+        }
+    }
+}
+
+// Test para aplicar la tabla sobre el mismo canal y sobre un canal de otro ancho
+TEST(LevelTableTest, AppliesInPlaceAndWidening) {
+    std::vector<uint8_t> channel = {0, 1, 127, 255};
+    std::vector<uint16_t> wide(channel.size());
+    applyLevelTable<uint8_t, uint16_t>(channel, wide, maxLevelTable<uint8_t, uint16_t>(255, 65535));
+    EXPECT_EQ(wide, (std::vector<uint16_t>{0, 257, 32639, 65535}));
+    applyLevelTable<uint8_t, uint8_t>(channel, channel, maxLevelTable<uint8_t, uint8_t>(255, 100));
+    EXPECT_EQ(channel, (std::vector<uint8_t>{0, 0, 49, 100}));
+}
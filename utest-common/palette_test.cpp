@@ -0,0 +1,121 @@
+#include "../common/palette.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+  std::string readFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+  }
+}
+
+// Test para el ancho mínimo de índice según el número de colores
+TEST(PaletteTest, IndexBits) {
+    EXPECT_EQ(indexBits(0), 1);
+    EXPECT_EQ(indexBits(2), 1);
+    EXPECT_EQ(indexBits(3), 2);
+    EXPECT_EQ(indexBits(16), 4);
+    EXPECT_EQ(indexBits(17), 8);
+    EXPECT_EQ(indexBits(257), 16);
+    EXPECT_EQ(indexBits(65537), 32);
+}
+
+// Test para la construcción de la paleta: orden de primera aparición, muchos colores (crece la tabla)
+TEST(PaletteTest, BuildKeepsFirstSeenOrder) {
+    constexpr size_t pixels = 10000;
+    const Palette palette = buildPalette(pixels, [](size_t index) {
+        const auto value = static_cast<uint>(index % 3000);
+        return colorKey(value, value / 2, 65535 - value);
+    });
+    ASSERT_EQ(palette.colors.size(), 3000);
+    for (size_t i = 0; i < pixels; ++i) {
+        ASSERT_EQ(palette.indices[i], i % 3000);
+        ASSERT_EQ(keyRed(palette.colors[palette.indices[i]]), i % 3000);
+    }
+}
+
+// Test para el empaquetado de índices estrechos (bit menos significativo primero) y anchos
+TEST(PaletteTest, PackIndices) {
+    const std::vector<uint32_t> indices = {1, 2, 3, 0, 2};
+    std::vector<uint8_t> out(packedBytes(indices.size(), 2));
+    packIndices(indices, 2, out);
+    EXPECT_EQ(out, (std::vector<uint8_t>{0x39, 0x02}));
+    std::vector<uint8_t> wide(packedBytes(2, 16));
+    packIndices(std::vector<uint32_t>{0x0102, 0x0304}, 16, wide);
+    EXPECT_EQ(wide, (std::vector<uint8_t>{0x02, 0x01, 0x04, 0x03}));
+}
+
+// Test para el archivo completo: cabecera, tabla de colores de 16 bits e índices de 1 bit
+TEST(PaletteTest, SaveCompressed) {
+    const std::vector<uint64_t> keys = {colorKey(1, 2, 3), colorKey(300, 0, 65535), colorKey(1, 2, 3)};
+    const Palette palette = buildPalette(keys.size(), [&keys](size_t index) { return keys[index]; });
+    saveCompressed("palette_out.cppm", {.width = 3, .height = 1, .maxColorValue = 65535}, palette);
+    const std::string expected = std::string("C6 3 1 65535 2\n") +
+                                 std::string("\x01\x00\x02\x00\x03\x00\x2C\x01\x00\x00\xFF\xFF", 12) +
+                                 std::string("\x02", 1);
+    EXPECT_EQ(readFile("palette_out.cppm"), expected);
+    static_cast<void>(std::remove("palette_out.cppm"));
+}
+
+// Test de ida y vuelta para cada ancho de índice: los canales decodificados coinciden
+TEST(CompressedFileTest, RoundTripEveryIndexWidth) {
+    for (const size_t colorCount : {2U, 3U, 9U, 200U, 5000U}) {
+        constexpr size_t width = 101;
+        constexpr size_t height = 97;
+        std::vector<uint8_t> red(width * height);
+        std::vector<uint8_t> green(width * height);
+        std::vector<uint8_t> blue(width * height);
+        for (size_t i = 0; i < red.size(); ++i) {
+            const size_t color = (i * 7919) % colorCount;
+            red[i] = static_cast<uint8_t>(color);
+            green[i] = static_cast<uint8_t>(color >> 8U);
+            blue[i] = static_cast<uint8_t>(color * 3);
+        }
+        const Palette palette = buildPalette(red.size(), [&](size_t index) {
+            return colorKey(red[index], green[index], blue[index]);
+        });
+        saveCompressed("roundtrip.cppm", {.width = width, .height = height, .maxColorValue = 255}, palette);
+
+        ASSERT_TRUE(isCompressedFile("roundtrip.cppm"));
+        const CompressedFile file("roundtrip.cppm");
+        EXPECT_EQ(file.format().width, width);
+        EXPECT_EQ(file.colors().size(), std::min<size_t>(colorCount, red.size()));
+        std::vector<uint8_t> red2(red.size());
+        std::vector<uint8_t> green2(red.size());
+        std::vector<uint8_t> blue2(red.size());
+        decodeChannels<uint8_t>(file, red2, green2, blue2);
+        EXPECT_EQ(red2, red);
+        EXPECT_EQ(green2, green);
+        EXPECT_EQ(blue2, blue);
+    }
+    static_cast<void>(std::remove("roundtrip.cppm"));
+}
+
+// Test para descomprimir a PPM (muestras de 16 bits en big-endian)
+TEST(CompressedFileTest, DecompressToPPM) {
+    std::ofstream("decompress_in.cppm", std::ios::binary)
+        << std::string("C6 3 1 65535 2\n") << std::string("\x01\x00\x02\x00\x03\x00\x2C\x01\x00\x00\xFF\xFF", 12)
+        << std::string("\x02", 1);
+    decompressToPPM(CompressedFile("decompress_in.cppm"), "decompress_out.ppm");
+    const std::string expected = std::string("P6\n3 1\n65535\n") +
+        std::string("\x00\x01\x00\x02\x00\x03\x01\x2C\x00\x00\xFF\xFF\x00\x01\x00\x02\x00\x03", 18);
+    EXPECT_EQ(readFile("decompress_out.ppm"), expected);
+    static_cast<void>(std::remove("decompress_in.cppm"));
+    static_cast<void>(std::remove("decompress_out.ppm"));
+}
+
+// Test para archivos comprimidos corruptos: índice fuera de la tabla y datos truncados
+TEST(CompressedFileTest, RejectsCorruptFiles) {
+    std::ofstream("corrupt.cppm", std::ios::binary) << std::string("C6 2 2 255 3\n\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0F", 23);
+    const CompressedFile file("corrupt.cppm");
+    std::vector<uint8_t> channel(4);
+    EXPECT_THROW(decodeChannels<uint8_t>(file, channel, channel, channel), std::runtime_error);
+    std::ofstream("corrupt.cppm", std::ios::binary) << std::string("C6 2 2 255 3\n\x01\x02", 15);
+    EXPECT_THROW(CompressedFile("corrupt.cppm"), std::runtime_error);
+    static_cast<void>(std::remove("corrupt.cppm"));
+}
@@ -0,0 +1,55 @@
+#include "../common/ppminfo.hpp"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+  void writeFile(const std::filesystem::path& filename, const std::string& contents) {
+    std::ofstream file(filename, std::ios::binary);
+    file << contents;
+  }
+}
+
+// Test para info por lotes sobre un directorio: solo .ppm, ordenados, con errores por imagen
+TEST(InfoBatchTest, DirectorySource) {
+    const std::filesystem::path dir = "info_batch_dir";
+    std::filesystem::create_directory(dir);
+    writeFile(dir / "b.ppm", std::string("P6\n3 1\n65535\n") + std::string(18, '\0'));
+    writeFile(dir / "a.ppm", "P6\n# comentario\n2 2\n255\n");
+    writeFile(dir / "c.ppm", "P3\n1 1\n255\n");
+    writeFile(dir / "notas.txt", "no es una imagen");
+
+    ASSERT_TRUE(isInfoBatchSource(dir.string()));
+    const std::vector<std::string> paths = listInfoInputs(dir.string());
+    ASSERT_EQ(paths.size(), 3);
+    ThreadPool pool(2);
+    const std::vector<InfoEntry> entries = readInfoBatch(paths, pool);
+    ASSERT_EQ(entries.size(), 3);
+    EXPECT_EQ(entries[0].path, (dir / "a.ppm").string());
+    EXPECT_EQ(entries[0].header.width, 2);
+    EXPECT_EQ(entries[0].header.maxColorValue, 255);
+    EXPECT_EQ(entries[1].header.width, 3);
+    EXPECT_EQ(entries[1].header.maxColorValue, 65535);
+    EXPECT_TRUE(entries[0].error.empty());
+    EXPECT_FALSE(entries[2].error.empty());
+    std::filesystem::remove_all(dir);
+}
+
+// Test para info por lotes a partir de una lista de archivos
+TEST(InfoBatchTest, ListSource) {
+    writeFile("info_list_one.ppm", "P6\n5 4\n255\n");
+    writeFile("info_list.txt", "info_list_one.ppm\r\n\nno_existe.ppm\n");
+
+    ASSERT_TRUE(isInfoBatchSource("@info_list.txt"));
+    EXPECT_FALSE(isInfoBatchSource("info_list_one.ppm"));
+    const std::vector<std::string> paths = listInfoInputs("@info_list.txt");
+    ASSERT_EQ(paths.size(), 2);
+    ThreadPool pool(2);
+    const std::vector<InfoEntry> entries = readInfoBatch(paths, pool);
+    EXPECT_EQ(entries[0].header.height, 4);
+    EXPECT_FALSE(entries[1].error.empty());
+    std::filesystem::remove("info_list_one.ppm");
+    std::filesystem::remove("info_list.txt");
+}
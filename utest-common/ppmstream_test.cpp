@@ -0,0 +1,73 @@
+#include "../common/ppmstream.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace {
+  void writeFile(const std::string& filename, const std::string& contents) {
+    std::ofstream file(filename, std::ios::binary);
+    file << contents;
+  }
+
+  std::string readFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+  }
+}
+
+// Test para maxlevel por bloques en 8 bits (bloques de una sola fila)
+TEST(StreamMaxLevelTest, EightBitBlocks) {
+    const std::string input = "stream_in8.ppm";
+    const std::string output = "stream_out8.ppm";
+    writeFile(input, std::string("P6\n2 2\n200\n") + std::string("\x00\x64\xC8\x0A\x14\x1E\x01\x02\x03\xC7\xC6\xC5", 12));
+    streamMaxLevel(StreamJob{.input = input, .output = output, .blockBytes = 1}, 100);
+    EXPECT_EQ(readFile(output), std::string("P6\n2 2\n100\n") + std::string("\x00\x32\x64\x05\x0A\x0F\x00\x01\x01\x63\x63\x62", 12));
+    static_cast<void>(std::remove(input.c_str()));
+    static_cast<void>(std::remove(output.c_str()));
+}
+
+// Test para el cambio de profundidad de 8 a 16 bits (muestras big-endian)
+TEST(StreamMaxLevelTest, EightToSixteenBit) {
+    const std::string input = "stream_in816.ppm";
+    const std::string output = "stream_out816.ppm";
+    writeFile(input, std::string("P6\n1 1\n255\n\x01\x80\xFF", 14));
+    streamMaxLevel(StreamJob{.input = input, .output = output}, 65535);
+    EXPECT_EQ(readFile(output), std::string("P6\n1 1\n65535\n\x01\x01\x80\x80\xFF\xFF", 19));
+    static_cast<void>(std::remove(input.c_str()));
+    static_cast<void>(std::remove(output.c_str()));
+}
+
+// Test para el cambio de profundidad de 16 a 8 bits
+TEST(StreamMaxLevelTest, SixteenToEightBit) {
+    const std::string input = "stream_in168.ppm";
+    const std::string output = "stream_out168.ppm";
+    writeFile(input, std::string("P6\n1 1\n65535\n\xFF\xFF\x80\x00\x00\xFF", 19));
+    streamMaxLevel(StreamJob{.input = input, .output = output}, 255);
+    EXPECT_EQ(readFile(output), std::string("P6\n1 1\n255\n\xFF\x7F\x00", 14));
+    static_cast<void>(std::remove(input.c_str()));
+    static_cast<void>(std::remove(output.c_str()));
+}
+
+// Test para maxlevel en una sola pasada: mismo resultado que por bloques en las cuatro
+// combinaciones de profundidad, con varios fragmentos por bloque
+TEST(FusedMaxLevelTest, MatchesStreaming) {
+    const std::string output = "fused_out.ppm";
+    const std::string expected = "fused_expected.ppm";
+    for (const std::string maxval : {"255", "65535"}) {
+        const std::string input = "fused_in" + maxval + ".ppm";
+        const size_t sampleBytes = maxval == "255" ? 1 : 2;
+        std::string payload(size_t{301} * 251 * 3 * sampleBytes, '\0');
+        for (size_t i = 0; i < payload.size(); ++i) { payload[i] = static_cast<char>((i * 131) ^ (i >> 7)); }
+        writeFile(input, "P6\n301 251\n" + maxval + "\n" + payload);
+        for (const uint newMax : {100U, 255U, 1000U, 65535U}) {
+            streamMaxLevel(StreamJob{.input = input, .output = expected, .blockBytes = 4096}, newMax);
+            fusedMaxLevel(PPMFile(input), output, newMax);
+            EXPECT_EQ(readFile(output), readFile(expected)) << maxval << " -> " << newMax;
+        }
+        static_cast<void>(std::remove(input.c_str()));
+    }
+    static_cast<void>(std::remove(output.c_str()));
+    static_cast<void>(std::remove(expected.c_str()));
+}
@@ -40,6 +40,14 @@ TEST(ProcessArgsTest, ResizeOperationValidArgs) {
     EXPECT_EQ(result.extraParams[1], "300");
 }
 
+// Test para operación "resize" con filtro
+TEST(ProcessArgsTest, ResizeOperationWithFilter) {
+    const std::vector<std::string> arguments = {"program", "input.ppm", "output.ppm", "resize", "200", "300", "lanczos3"};
+    ProgramArgs result = processArgs(arguments);
+    ASSERT_EQ(result.extraParams.size(), 3);
+    EXPECT_EQ(result.extraParams[2], "lanczos3");
+}
+
 // Test para operación "cutfreq" con argumentos correctos
 TEST(ProcessArgsTest, CutFreqOperationValidArgs) {
     const std::vector<std::string> arguments = {"program", "input.ppm", "output.ppm", "cutfreq", "10"};
@@ -61,6 +69,16 @@ TEST(ProcessArgsTest, CompressOperationValidArgs) {
     EXPECT_TRUE(result.extraParams.empty());
 }
 
+// Test para operación "decompress" con argumentos correctos
+TEST(ProcessArgsTest, DecompressOperationValidArgs) {
+    const std::vector<std::string> arguments = {"program", "input.ppm", "output.ppm", "decompress"};
+    const ProgramArgs result = processArgs(arguments);
+    EXPECT_EQ(result.inputFile, "input.ppm");
+    EXPECT_EQ(result.outputFile, "output.ppm");
+    EXPECT_EQ(result.operation, "decompress");
+    EXPECT_TRUE(result.extraParams.empty());
+}
+
 // Test para cantidad insuficiente de argumentos
 TEST(ProcessArgsTest, InvalidNumberOfArgs) {
     const std::vector<std::string> arguments = {"program", "input.ppm", "output.ppm"};
@@ -103,6 +121,12 @@ TEST(ValidateResizeTest, ResizeInvalidHeight) {
   EXPECT_THROW(processArgs(arguments), std::runtime_error);
 }
 
+// Test para un filtro desconocido en el comando "resize"
+TEST(ValidateResizeTest, ResizeInvalidFilter) {
+  const std::vector<std::string> arguments = {"program", "input.ppm", "output.ppm", "resize", "200", "300", "sinc"};
+  EXPECT_THROW(processArgs(arguments), std::runtime_error);
+}
+
 // Test para valor de "cutfreq" no numérico
 TEST(ValidateCutFreqTest, CutFreqNonNumeric) {
     const std::vector<std::string> arguments = {"program", "input.ppm", "output.ppm", "cutfreq", "abc"};
@@ -0,0 +1,90 @@
+#include "../common/ratioresize.hpp"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace {
+  double interpolate(double value1, double value2, double weight) {
+    return value1 + (weight * (value2 - value1));
+  }
+
+  // Bilinear de referencia en double, redondeando una vez o tras cada pasada
+  template <typename Sample>
+  std::vector<Sample> referenceResize(std::vector<Sample> const & source, RatioPlan const & plan,
+                                      std::pair<double, double> steps) {
+    const RatioAxis& columns = plan.columns;
+    const RatioAxis& rows = plan.rows;
+    const bool perPass = plan.rounding == RatioRounding::perPass;
+    std::vector<Sample> output(columns.outputs * rows.outputs * plan.channels);
+    for (size_t y = 0; y < rows.outputs; ++y) {
+      const double target_y = static_cast<double>(y) * steps.second;
+      const auto low_y = static_cast<size_t>(std::floor(target_y));
+      const size_t high_y = std::min(low_y + 1, rows.sourceSize - 1);
+      for (size_t x = 0; x < columns.outputs; ++x) {
+        const double target_x = static_cast<double>(x) * steps.first;
+        const auto low_x = static_cast<size_t>(std::floor(target_x));
+        const size_t high_x = std::min(low_x + 1, columns.sourceSize - 1);
+        for (size_t c = 0; c < plan.channels; ++c) {
+          auto at = [&](size_t px, size_t py) {
+            return static_cast<double>(source[(((py * columns.sourceSize) + px) * plan.channels) + c]);
+          };
+          double top = interpolate(at(low_x, low_y), at(high_x, low_y), target_x - static_cast<double>(low_x));
+          double bottom = interpolate(at(low_x, high_y), at(high_x, high_y), target_x - static_cast<double>(low_x));
+          if (perPass) {
+            top = std::round(top);
+            bottom = std::round(bottom);
+          }
+          output[(((y * columns.outputs) + x) * plan.channels) + c] =
+              static_cast<Sample>(std::round(interpolate(top, bottom, target_y - static_cast<double>(low_y))));
+        }
+      }
+    }
+    return output;
+  }
+}
+
+// Test para ratioAxis: solo acepta pasos de 4, 2, 1, 1/2 y 1/4 que no se salgan del origen
+TEST(RatioResizeTest, RecognisesSteps) {
+    EXPECT_EQ(ratioAxis(2, 9, 5)->step, 2U);
+    EXPECT_EQ(ratioAxis(4, 9, 3)->step, 4U);
+    EXPECT_EQ(ratioAxis(1, 9, 9)->step, 1U);
+    EXPECT_EQ(ratioAxis(0.5, 5, 9)->upShift, 1U);
+    EXPECT_EQ(ratioAxis(0.25, 5, 17)->upShift, 2U);
+    EXPECT_FALSE(ratioAxis(3, 10, 4));
+    EXPECT_FALSE(ratioAxis(0.3, 10, 30));
+    EXPECT_FALSE(ratioAxis(8, 17, 3));
+    EXPECT_FALSE(ratioAxis(std::numeric_limits<double>::infinity(), 5, 1));
+    EXPECT_FALSE(ratioAxis(std::nan(""), 1, 1));
+    EXPECT_FALSE(ratioAxis(2, 8, 5));
+}
+
+// Test para ratioResize: mismo resultado que el bilineal en double en todas las combinaciones de pasos
+TEST(RatioResizeTest, MatchesDoubleBilinear) {
+    const size_t width = 13;
+    const size_t height = 9;
+    for (const size_t channels : {1UL, 3UL}) {
+        std::vector<uint16_t> source(width * height * channels);
+        for (size_t i = 0; i < source.size(); ++i) { source[i] = static_cast<uint16_t>((i * 7919) % 65536); }
+        for (const double step_x : {4.0, 2.0, 1.0, 0.5, 0.25}) {
+            for (const double step_y : {4.0, 2.0, 1.0, 0.5, 0.25}) {
+                const auto outputs = [](size_t size, double step) {
+                    return static_cast<size_t>(std::floor(static_cast<double>(size - 1) / step)) + 1;
+                };
+                const auto columns = ratioAxis(step_x, width, outputs(width, step_x));
+                const auto rows = ratioAxis(step_y, height, outputs(height, step_y));
+                ASSERT_TRUE(columns && rows);
+                for (const RatioRounding rounding : {RatioRounding::once, RatioRounding::perPass}) {
+                    const RatioPlan plan = {.columns = *columns, .rows = *rows, .channels = channels, .rounding = rounding};
+                    std::vector<uint16_t> output(columns->outputs * rows->outputs * channels);
+                    ratioResize(std::span<const uint16_t>(source), plan, RowRange{.first = 0, .count = rows->outputs},
+                                std::span<uint16_t>(output));
+                    EXPECT_EQ(output, referenceResize(source, plan, {step_x, step_y}))
+                        << step_x << ' ' << step_y << ' ' << channels;
+                }
+            }
+        }
+    }
+}
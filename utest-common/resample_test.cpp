@@ -0,0 +1,123 @@
+#include "../common/resample.hpp"
+#include "../imgsoa/imagesoa.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace {
+  constexpr std::array<ResizeFilter, 4> filters = {ResizeFilter::nearest, ResizeFilter::box,
+                                                   ResizeFilter::bicubic, ResizeFilter::lanczos3};
+
+  // Plan de un canal de width x height a newWidth x newHeight
+  ResamplePlan channelPlan(ResizeFilter filter, Dimensions source, Dimensions target,
+                           uint maxValue) {
+    return {.columns   = resampleKernels(filter, target.width, source.width),
+            .rows      = resampleKernels(filter, target.height, source.height),
+            .rowLength = source.width,
+            .maxValue  = maxValue};
+  }
+
+  template <typename Sample>
+  std::vector<Sample> resampleChannel(std::vector<Sample> const & source, ResamplePlan const & plan) {
+    std::vector<Sample> output(plan.columns.first.size() * plan.rows.first.size());
+    resample(std::span<Sample const>(source), plan,
+             RowRange{.first = 0, .count = plan.rows.first.size()}, std::span<Sample>(output));
+    return output;
+  }
+}
+
+// Test para los núcleos: los pesos de cada salida suman 1 y no se salen de la fila
+TEST(ResampleTest, KernelWeightsAddUpToOne) {
+    for (const ResizeFilter filter : filters) {
+        for (const auto& [outputs, sourceSize] : {std::pair{7UL, 100UL}, std::pair{100UL, 7UL},
+                                                  std::pair{1UL, 9UL}, std::pair{13UL, 13UL}}) {
+            const ResampleKernels kernels = resampleKernels(filter, outputs, sourceSize);
+            ASSERT_EQ(kernels.first.size(), outputs);
+            for (size_t i = 0; i < outputs; ++i) {
+                EXPECT_LE(kernels.first[i] + kernels.count[i], sourceSize);
+                float total = 0;
+                for (size_t tap = 0; tap < kernels.count[i]; ++tap) {
+                    total += kernels.weights[(i * kernels.taps) + tap];
+                }
+                EXPECT_NEAR(total, 1.0F, 1e-5F);
+            }
+        }
+    }
+}
+
+// Test para box: cada salida es la media del área que cubre
+TEST(ResampleTest, BoxAveragesCoveredArea) {
+    const std::vector<uint8_t> source = {10, 20, 30, 40, 50, 60,
+                                         70, 80, 90, 100, 110, 121};
+    const auto output = resampleChannel(
+        source, channelPlan(ResizeFilter::box, {.width = 6, .height = 2}, {.width = 2, .height = 1}, 255));
+    EXPECT_EQ(output, (std::vector<uint8_t>{50, 80}));
+}
+
+// Test para nearest: toma la muestra bajo el centro de cada salida
+TEST(ResampleTest, NearestPicksCentreSample) {
+    const std::vector<uint16_t> source = {0, 1000, 2000, 3000, 4000, 5000};
+    const auto output = resampleChannel(
+        source, channelPlan(ResizeFilter::nearest, {.width = 6, .height = 1}, {.width = 3, .height = 1}, 65535));
+    EXPECT_EQ(output, (std::vector<uint16_t>{1000, 3000, 5000}));
+}
+
+// Test para el mismo tamaño: todos los filtros devuelven la imagen tal cual
+TEST(ResampleTest, SameSizeKeepsSamples) {
+    std::vector<uint8_t> source(17 * 11);
+    for (size_t i = 0; i < source.size(); ++i) { source[i] = static_cast<uint8_t>((i * 37) % 256); }
+    for (const ResizeFilter filter : filters) {
+        const Dimensions size = {.width = 17, .height = 11};
+        EXPECT_EQ(resampleChannel(source, channelPlan(filter, size, size, 255)), source);
+    }
+}
+
+// Test para bicubic y lanczos3: los rebotes junto a un borde se limitan al valor máximo
+TEST(ResampleTest, OvershootIsClamped) {
+    std::vector<uint16_t> source(40);
+    for (size_t i = 20; i < source.size(); ++i) { source[i] = 1000; }
+    for (const ResizeFilter filter : {ResizeFilter::bicubic, ResizeFilter::lanczos3}) {
+        const auto output = resampleChannel(
+            source, channelPlan(filter, {.width = 40, .height = 1}, {.width = 97, .height = 1}, 1000));
+        EXPECT_EQ(*std::ranges::max_element(output), 1000);
+        EXPECT_EQ(*std::ranges::min_element(output), 0);
+    }
+}
+
+// Test para resize con filtro: un pase por bandas da lo mismo que un solo pase y cubre los tres canales
+TEST(ResampleTest, ImageResizeMatchesSinglePass) {
+    ImageSOA_16bit image(PPMMetadata{.magicNumber = "P6", .width = 300, .height = 200, .maxColorValue = 4095});
+    for (size_t i = 0; i < 300 * 200; ++i) {
+        image.gRed()[i] = static_cast<uint16_t>((i * 7) % 4096);
+        image.gGreen()[i] = static_cast<uint16_t>((i / 5) % 4096);
+        image.gBlue()[i] = static_cast<uint16_t>((i * i) % 4096);
+    }
+    const Dimensions target = {.width = 37, .height = 410};
+    const ResamplePlan plan = channelPlan(ResizeFilter::lanczos3, {.width = 300, .height = 200}, target, 4095);
+    const auto red = resampleChannel(image.gRed(), plan);
+    const auto green = resampleChannel(image.gGreen(), plan);
+    const auto blue = resampleChannel(image.gBlue(), plan);
+    image.sResizeFilter(ResizeFilter::lanczos3);
+    image.resize(target);
+    EXPECT_EQ(image.gRed(), red);
+    EXPECT_EQ(image.gGreen(), green);
+    EXPECT_EQ(image.gBlue(), blue);
+}
+
+// Test para box a la mitad exacta: cada salida es la media redondeada de su bloque 2 x 2, limitada al valor máximo
+TEST(ResampleTest, HalvingAveragesBlocks) {
+    const Dimensions source = {.width = 8, .height = 6};
+    std::vector<uint16_t> samples(source.width * source.height);
+    for (size_t i = 0; i < samples.size(); ++i) { samples[i] = static_cast<uint16_t>((i * 97) % 1100); }
+    const auto output = resampleChannel(
+        samples, channelPlan(ResizeFilter::box, source, {.width = 4, .height = 3}, 1000));
+    for (size_t y = 0; y < 3; ++y) {
+        for (size_t x = 0; x < 4; ++x) {
+            const size_t corner = (2 * y * source.width) + (2 * x);
+            const uint sum = uint{samples[corner]} + samples[corner + 1] + samples[corner + source.width] +
+                             samples[corner + source.width + 1];
+            EXPECT_EQ(output[(y * 4) + x], std::min((sum + 2) / 4, 1000U)) << x << ' ' << y;
+        }
+    }
+}
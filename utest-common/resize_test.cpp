@@ -0,0 +1,180 @@
+#include "../common/imtool_soa_aux.hpp"
+#include "../imgsoa/imagesoa.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+  constexpr size_t width = 53;
+  constexpr size_t height = 29;
+
+  // Canal con un patrón sin periodos cortos
+  template <typename Sample>
+  std::vector<Sample> patternChannel(size_t const multiplier) {
+    std::vector<Sample> channel(width * height);
+    for (size_t i = 0; i < channel.size(); ++i) {
+      channel[i] = static_cast<Sample>((i * multiplier) % 251);
+    }
+    return channel;
+  }
+
+  // Valor esperado de un píxel de salida calculado punto a punto con helper_resizeInterpolate
+  template <typename Image, typename Sample>
+  double pointValue(std::vector<Sample> & channel, double x_target, double y_target) {
+    Dimensions const source{.width = width, .height = height};
+    if (std::floor(x_target) == x_target && std::floor(y_target) == y_target) {
+      return channel[(static_cast<size_t>(y_target) * width) + static_cast<size_t>(x_target)];
+    }
+    return Image::helper_resizeInterpolate(channel, source, x_target, y_target);
+  }
+
+  std::string readFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+  }
+
+  // Mayor diferencia entre el resize de punto fijo y el valor bilineal exacto redondeado
+  template <typename Image, typename Sample>
+  double fixedPointDeviation(Dimensions dim, uint maxValue) {
+    Image image(
+      PPMMetadata{.magicNumber = "P6", .width = width, .height = height, .maxColorValue = maxValue});
+    std::mt19937 generator(maxValue);
+    std::uniform_int_distribution<uint> distribution(0, maxValue);
+    for (auto& sample : image.gRed()) { sample = static_cast<Sample>(distribution(generator)); }
+    std::vector<Sample> source = image.gRed();
+    image.sResizePrecision(ResizePrecision::fixedPoint);
+    std::vector<Sample> const resized = image.resize_helper(image.gRed(), dim);
+    double width_div = static_cast<double>(width) / static_cast<double>(dim.width);
+    double height_div = static_cast<double>(height) / static_cast<double>(dim.height);
+    if constexpr (sizeof(Sample) == 1) {
+        width_div = (width - 1.0) / static_cast<double>(dim.width - 1);
+        height_div = (height - 1.0) / static_cast<double>(dim.height - 1);
+    }
+    double deviation = 0;
+    for (size_t y = 0; y < dim.height; ++y) {
+      for (size_t x = 0; x < dim.width; ++x) {
+        double const value = pointValue<Image>(source, static_cast<double>(x) * width_div,
+                                               static_cast<double>(y) * height_div);
+        deviation = std::max(deviation, std::abs(resized[(y * dim.width) + x] - std::round(value)));
+      }
+    }
+    return deviation;
+  }
+}
+
+// Test para resize de 8 bits: las tablas por fila y columna dan lo mismo que el cálculo por píxel
+TEST(ResizeTest, EightBitMatchesPointInterpolation) {
+    for (const Dimensions dim : {Dimensions{.width = 20, .height = 71},
+                                 Dimensions{.width = 100, .height = 13}}) {
+        ImageSOA_8bit image(
+          PPMMetadata{.magicNumber = "P6", .width = width, .height = height, .maxColorValue = 255});
+        image.gRed() = patternChannel<uint8_t>(7);
+        std::vector<uint8_t> source = image.gRed();
+        std::vector<uint8_t> const resized = image.resize_helper(image.gRed(), dim);
+        double const width_div = (width - 1.0) / static_cast<double>(dim.width - 1);
+        double const height_div = (height - 1.0) / static_cast<double>(dim.height - 1);
+        for (size_t y = 0; y < dim.height; ++y) {
+            for (size_t x = 0; x < dim.width; ++x) {
+                double const value = pointValue<ImageSOA_8bit>(
+                  source, static_cast<double>(x) * width_div, static_cast<double>(y) * height_div);
+                ASSERT_EQ(resized[(y * dim.width) + x], static_cast<uint8_t>(std::round(value)));
+            }
+        }
+    }
+}
+
+// Test para resize de 16 bits: las tablas por fila y columna dan lo mismo que el cálculo por píxel
+TEST(ResizeTest, SixteenBitMatchesPointInterpolation) {
+    for (const Dimensions dim : {Dimensions{.width = 20, .height = 71},
+                                 Dimensions{.width = 100, .height = 13}}) {
+        ImageSOA_16bit image(
+          PPMMetadata{.magicNumber = "P6", .width = width, .height = height, .maxColorValue = 1000});
+        image.gRed() = patternChannel<uint16_t>(13);
+        std::vector<uint16_t> source = image.gRed();
+        std::vector<uint16_t> const resized = image.resize_helper(image.gRed(), dim);
+        double const width_div = static_cast<double>(width) / static_cast<double>(dim.width);
+        double const height_div = static_cast<double>(height) / static_cast<double>(dim.height);
+        for (size_t y = 0; y < dim.height; ++y) {
+            for (size_t x = 0; x < dim.width; ++x) {
+                double const value = pointValue<ImageSOA_16bit>(
+                  source, static_cast<double>(x) * width_div, static_cast<double>(y) * height_div);
+                ASSERT_EQ(resized[(y * dim.width) + x], static_cast<uint16_t>(std::round(value)));
+            }
+        }
+    }
+}
+
+// Test para el resize de punto fijo: como mucho 1 de diferencia en 8 bits y 2 en 16 bits
+TEST(ResizeTest, FixedPointDeviationIsBounded) {
+    for (const Dimensions dim : {Dimensions{.width = 20, .height = 71},
+                                 Dimensions{.width = 100, .height = 13},
+                                 Dimensions{.width = 211, .height = 97}}) {
+        EXPECT_LE((fixedPointDeviation<ImageSOA_8bit, uint8_t>(dim, 255)), 1);
+        EXPECT_LE((fixedPointDeviation<ImageSOA_16bit, uint16_t>(dim, 255)), 1);
+        EXPECT_LE((fixedPointDeviation<ImageSOA_16bit, uint16_t>(dim, 65535)), 2);
+    }
+}
+
+// Test para el resize por filas desde el archivo: mismo PPM que cargar la imagen y redimensionarla
+TEST(ResizeTest, StreamedMatchesInMemory) {
+    const std::string expected = "resize_expected.ppm";
+    const std::string streamed = "resize_streamed.ppm";
+    for (const std::string maxval : {"255", "1000"}) {
+        const std::string input = "resize_in" + maxval + ".ppm";
+        std::string payload(width * height * 3 * (maxval == "255" ? 1 : 2), '\0');
+        for (size_t i = 0; i < payload.size(); ++i) { payload[i] = static_cast<char>((i * 131) ^ (i >> 5)); }
+        std::ofstream(input, std::ios::binary) << "P6\n" << width << ' ' << height << '\n' << maxval << '\n' << payload;
+        for (const Dimensions dim : {Dimensions{.width = 20, .height = 7},
+                                     Dimensions{.width = 100, .height = 64},
+                                     Dimensions{.width = 53, .height = 29}}) {
+            if (maxval == "255") {
+                ImageSOA_8bit image(loadMetadata(input));
+                image.loadData(input);
+                image.resize(dim);
+                image.saveToFile(expected);
+            } else {
+                ImageSOA_16bit image(loadMetadata(input));
+                image.loadData(input);
+                image.resize(dim);
+                image.saveToFileBE(expected);
+            }
+            streamResize(StreamJob{.input = input, .output = streamed}, dim);
+            EXPECT_EQ(readFile(streamed), readFile(expected)) << maxval << ' ' << dim.width << 'x' << dim.height;
+        }
+        static_cast<void>(std::remove(input.c_str()));
+    }
+    static_cast<void>(std::remove(expected.c_str()));
+    static_cast<void>(std::remove(streamed.c_str()));
+}
+
+// Test para pyramid: cada nivel es el resize box del anterior y se guarda con su tamaño en el nombre
+TEST(ResizeTest, PyramidMatchesChainedResize) {
+    const std::string input = "pyramid_in.ppm";
+    std::string payload(width * height * 3, '\0');
+    for (size_t i = 0; i < payload.size(); ++i) { payload[i] = static_cast<char>((i * 131) ^ (i >> 5)); }
+    std::ofstream(input, std::ios::binary) << "P6\n" << width << ' ' << height << "\n255\n" << payload;
+    ASSERT_EQ(runCommand({"imtool-soa", input, "pyramid.ppm", "pyramid", "26x14,13,5x3"}), 0);
+
+    ImageSOA_8bit image(loadMetadata(input));
+    image.loadData(input);
+    image.sResizeFilter(ResizeFilter::box);
+    const std::string expected = "pyramid_expected.ppm";
+    for (const Dimensions dim : {Dimensions{.width = 26, .height = 14}, Dimensions{.width = 13, .height = 7},
+                                 Dimensions{.width = 5, .height = 3}}) {
+        image = image.resized(dim);
+        image.saveToFile(expected);
+        const std::string level = "pyramid-" + std::to_string(dim.width) + "x" + std::to_string(dim.height) + ".ppm";
+        EXPECT_EQ(readFile(level), readFile(expected)) << level;
+        static_cast<void>(std::remove(level.c_str()));
+    }
+    EXPECT_EQ(runCommand({"imtool-soa", input, "pyramid.ppm", "pyramid", "13x7,26x14"}), -1);
+    static_cast<void>(std::remove(input.c_str()));
+    static_cast<void>(std::remove(expected.c_str()));
+}
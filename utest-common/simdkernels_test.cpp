@@ -0,0 +1,170 @@
+#include "../common/simdkernels.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+  constexpr std::array<SimdLevel, 4> levels = {SimdLevel::scalar, SimdLevel::sse2, SimdLevel::avx2,
+                                               SimdLevel::avx512};
+
+  // Restaura el nivel detectado al terminar cada test
+  class SimdKernelsTest : public ::testing::Test {
+    protected:
+      void TearDown() override { selectSimdLevel(detectedSimdLevel()); }
+  };
+
+  template <typename Sample>
+  std::vector<Sample> randomSamples(size_t size, uint maxValue, uint seed) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<uint> distribution(0, maxValue);
+    std::vector<Sample> samples(size);
+    for (auto& sample : samples) { sample = static_cast<Sample>(distribution(generator)); }
+    return samples;
+  }
+
+  // Resultado de scaleSamples en cada nivel disponible, comparado con el escalar. El tamaño no es
+  // múltiplo de ningún ancho de vector, para probar también la cola.
+  template <typename In, typename Out>
+  void expectSameScale(uint currentMax, uint newMax) {
+    const std::vector<In> input = randomSamples<In>(1013, currentMax, currentMax + newMax);
+    const LevelScale scale = {.currentMax = currentMax, .newMax = newMax};
+    selectSimdLevel(SimdLevel::scalar);
+    std::vector<Out> expected(input.size());
+    scaleSamples(input, expected, scale);
+    for (const SimdLevel level : levels) {
+      if (selectSimdLevel(level) != level) { continue; }
+      std::vector<Out> output(input.size());
+      scaleSamples(input, output, scale);
+      ASSERT_EQ(output, expected) << "level " << static_cast<int>(level);
+    }
+  }
+
+  // Taps al azar sobre una fila de length muestras, con el peso en todo su rango
+  BilinearTaps randomTaps(size_t outputs, size_t length, uint seed) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<size_t> position(0, length - 1);
+    std::uniform_int_distribution<uint32_t> weight(0, 1U << bilinearWeightBits);
+    BilinearTaps taps;
+    for (size_t i = 0; i < outputs; ++i) {
+      const size_t low = position(generator);
+      taps.low.push_back(static_cast<uint32_t>(low));
+      taps.high.push_back(static_cast<uint32_t>(std::min(low + 1, length - 1)));
+      taps.weight.push_back(weight(generator));
+    }
+    return taps;
+  }
+
+  // Resultado de bilinearResize en cada nivel disponible, comparado con el escalar
+  template <typename Sample>
+  void expectSameBilinear(uint maxValue) {
+    constexpr size_t width = 61;
+    constexpr size_t height = 19;
+    const std::vector<Sample> source = randomSamples<Sample>(width * height, maxValue, maxValue);
+    const BilinearPlan plan = {.columns = randomTaps(103, width, 1),
+                               .rows = randomTaps(37, height, 2),
+                               .rowLength = width};
+    selectSimdLevel(SimdLevel::scalar);
+    std::vector<Sample> expected(103 * 37);
+    bilinearResize(source, plan, expected);
+    for (const SimdLevel level : levels) {
+      if (selectSimdLevel(level) != level) { continue; }
+      std::vector<Sample> output(expected.size());
+      bilinearResize(source, plan, output);
+      ASSERT_EQ(output, expected) << "level " << static_cast<int>(level);
+    }
+  }
+}
+
+// Test para scaleSamples: todos los niveles coinciden con el escalar en las cuatro conversiones
+TEST_F(SimdKernelsTest, ScaleMatchesScalar) {
+    expectSameScale<uint8_t, uint8_t>(255, 100);
+    expectSameScale<uint8_t, uint8_t>(200, 255);
+    expectSameScale<uint8_t, uint16_t>(255, 65535);
+    expectSameScale<uint8_t, uint16_t>(77, 40000);
+    expectSameScale<uint16_t, uint16_t>(65535, 1000);
+    expectSameScale<uint16_t, uint16_t>(1000, 65535);
+    expectSameScale<uint16_t, uint8_t>(65535, 255);
+    expectSameScale<uint16_t, uint8_t>(300, 7);
+}
+
+// Test para scaleSamples en el escalar: coincide con el redondeo de maxlevel
+TEST_F(SimdKernelsTest, ScaleUsesMaxLevelRounding) {
+    selectSimdLevel(SimdLevel::scalar);
+    std::vector<uint8_t> channel = {0, 1, 127, 255};
+    scaleSamples(channel, channel, {.currentMax = 255, .newMax = 100});
+    EXPECT_EQ(channel, (std::vector<uint8_t>{0, 0, 49, 100}));
+}
+
+// Test para firstDifference: encuentra la primera diferencia por encima del límite en cada nivel
+TEST_F(SimdKernelsTest, FirstDifference) {
+    const std::vector<uint8_t> base8 = randomSamples<uint8_t>(517, 255, 1);
+    const std::vector<uint16_t> base16 = randomSamples<uint16_t>(517, 65535, 2);
+    for (const SimdLevel level : levels) {
+        if (selectSimdLevel(level) != level) { continue; }
+        EXPECT_EQ(firstDifference(base8, base8, 3), base8.size());
+        EXPECT_EQ(firstDifference(base16, base16, 3), base16.size());
+        for (const size_t position : {size_t{0}, size_t{40}, size_t{300}, size_t{516}}) {
+            std::vector<uint8_t> other8 = base8;
+            std::vector<uint16_t> other16 = base16;
+            // Diferencias por debajo del límite antes de la posición buscada
+            if (position > 0) {
+                other8[position - 1] = static_cast<uint8_t>(other8[position - 1] ^ 1U);
+                other16[position - 1] = static_cast<uint16_t>(other16[position - 1] ^ 1U);
+            }
+            other8[position] = static_cast<uint8_t>(other8[position] + 128);
+            other16[position] = static_cast<uint16_t>(other16[position] + 40000);
+            EXPECT_EQ(firstDifference(base8, other8, 3), position);
+            EXPECT_EQ(firstDifference(other8, base8, 3), position);
+            EXPECT_EQ(firstDifference(base16, other16, 3), position);
+            EXPECT_EQ(firstDifference(other16, base16, 3), position);
+        }
+    }
+}
+
+// Test para nextMarkedPixel: mismos píxeles marcados en cada nivel
+TEST_F(SimdKernelsTest, NextMarkedPixel) {
+    const std::vector<uint8_t> red = randomSamples<uint8_t>(1001, 3, 3);
+    const std::vector<uint8_t> green = randomSamples<uint8_t>(1001, 3, 4);
+    const std::vector<uint8_t> blue = randomSamples<uint8_t>(1001, 3, 5);
+    ColorMarks marks;
+    marks.mark(1, 2, 3);
+    marks.mark(0, 0, 0);
+    std::vector<size_t> expected;
+    for (size_t i = 0; i < red.size(); ++i) {
+        if (marks.marked(red[i], green[i], blue[i])) { expected.push_back(i); }
+    }
+    ASSERT_FALSE(expected.empty());
+    const Planes8 planes = {.red = red, .green = green, .blue = blue};
+    for (const SimdLevel level : levels) {
+        if (selectSimdLevel(level) != level) { continue; }
+        std::vector<size_t> found;
+        for (size_t i = nextMarkedPixel(planes, marks, 0); i < red.size();
+             i = nextMarkedPixel(planes, marks, i + 1)) {
+            found.push_back(i);
+        }
+        EXPECT_EQ(found, expected);
+    }
+}
+
+// Test para bilinearResize: todos los niveles coinciden con el escalar, también junto al final
+// de la fila, donde los gathers pasan al escalar
+TEST_F(SimdKernelsTest, BilinearMatchesScalar) {
+    expectSameBilinear<uint8_t>(255);
+    expectSameBilinear<uint16_t>(255);
+    expectSameBilinear<uint16_t>(65535);
+}
+
+// Test para blendRow y blendRows: pesos 0 y 1 devuelven las muestras de origen
+TEST_F(SimdKernelsTest, BilinearEndWeightsAreExact) {
+    const std::vector<uint16_t> row = {0, 65535, 1234, 40000};
+    const BilinearTaps taps = {.low = {0, 1, 2, 3}, .high = {1, 2, 3, 3},
+                               .weight = {0, 0, 1U << bilinearWeightBits, 0}};
+    std::vector<uint32_t> blended(4);
+    blendRow(std::span<const uint16_t>(row), taps, blended);
+    std::vector<uint16_t> output(4);
+    blendRows({.top = blended, .bottom = blended, .weight = 0}, std::span<uint16_t>(output));
+    EXPECT_EQ(output, (std::vector<uint16_t>{0, 65535, 40000, 40000}));
+}
@@ -0,0 +1,56 @@
+#include "../common/soabatch.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+  void writeFile(const std::string& filename, const std::string& contents) {
+    std::ofstream file(filename, std::ios::binary);
+    file << contents;
+  }
+
+  std::string readFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+  }
+}
+
+// Test para la lectura del manifiesto: se saltan líneas vacías y comentarios
+TEST(BatchManifestTest, SkipsBlankAndCommentLines) {
+    writeFile("batch_manifest.txt", "# cabecera\n\nin.ppm out.ppm maxlevel 100\n  in.ppm   info\n");
+    const std::vector<BatchJob> jobs = readManifest("batch_manifest.txt");
+    ASSERT_EQ(jobs.size(), 2);
+    EXPECT_EQ(jobs[0].line, 3);
+    EXPECT_EQ(jobs[0].arguments, (std::vector<std::string>{"imtool-soa", "in.ppm", "out.ppm", "maxlevel", "100"}));
+    EXPECT_EQ(jobs[1].line, 4);
+    EXPECT_EQ(jobs[1].arguments.size(), 3);
+    static_cast<void>(std::remove("batch_manifest.txt"));
+}
+
+// Test para la ejecución por lotes: mismo resultado que la línea de comandos y estado por trabajo
+TEST(BatchRunTest, RunsJobsAndReportsStatus) {
+    writeFile("batch_in.ppm", std::string("P6\n2 1\n200\n") + std::string("\x00\x64\xC8\x0A\x14\x1E", 6));
+    writeFile("batch_manifest.txt", "batch_in.ppm batch_out1.ppm maxlevel 100\n"
+                                    "batch_in.ppm batch_out2.ppm maxlevel 100\n"
+                                    "no_existe.ppm batch_out3.ppm maxlevel 100\n"
+                                    "batch_in.ppm batch_out4.ppm maxlevel\n"
+                                    "batch_manifest.txt batch\n");
+    const std::vector<BatchJob> jobs = readManifest("batch_manifest.txt");
+    ThreadPool pool(2);
+    const std::vector<BatchResult> results = runBatch(jobs, pool);
+    ASSERT_EQ(results.size(), 5);
+    EXPECT_EQ(results[0].status, 0);
+    EXPECT_EQ(results[1].status, 0);
+    EXPECT_NE(results[2].status, 0);
+    EXPECT_NE(results[3].status, 0);
+    EXPECT_NE(results[4].status, 0);
+    const std::string expected = std::string("P6\n2 1\n100\n") + std::string("\x00\x32\x64\x05\x0A\x0F", 6);
+    EXPECT_EQ(readFile("batch_out1.ppm"), expected);
+    EXPECT_EQ(readFile("batch_out2.ppm"), expected);
+    for (const char* name : {"batch_in.ppm", "batch_manifest.txt", "batch_out1.ppm", "batch_out2.ppm"}) {
+        static_cast<void>(std::remove(name));
+    }
+}
@@ -0,0 +1,141 @@
+#include "../common/threadpool.hpp"
+#include "../common/imtool_soa_aux.hpp"
+#include "../imgsoa/imagesoa.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Test para comprobar que submit devuelve el resultado de la tarea
+TEST(ThreadPoolTest, SubmitReturnsResult) {
+    ThreadPool pool(2);
+    auto result = pool.submit([] { return 6 * 7; });
+    EXPECT_EQ(result.get(), 42);
+}
+
+// Test para comprobar que parallelFor visita cada índice exactamente una vez
+TEST(ThreadPoolTest, ParallelForVisitsEveryIndexOnce) {
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> visits(1000);
+    pool.parallelFor(visits.size(), [&visits](size_t index) { ++visits[index]; });
+    for (const auto& count : visits) {
+        EXPECT_EQ(count.load(), 1);
+    }
+}
+
+// Test para parallelFor anidado dentro de un hilo del pool (no debe bloquearse)
+TEST(ThreadPoolTest, NestedParallelFor) {
+    ThreadPool pool(2);
+    std::atomic<int> total{0};
+    pool.parallelFor(4, [&](size_t) {
+        pool.parallelFor(8, [&](size_t) { ++total; });
+    });
+    EXPECT_EQ(total.load(), 32);
+}
+
+// Test para la propagación de excepciones desde parallelFor
+TEST(ThreadPoolTest, ParallelForRethrows) {
+    ThreadPool pool(3);
+    std::atomic<int> visited{0};
+    EXPECT_THROW(pool.parallelFor(50, [&visited](size_t index) {
+        ++visited;
+        if (index == 7) { throw std::runtime_error("fallo"); }
+    }), std::runtime_error);
+    EXPECT_EQ(visited.load(), 50);
+}
+
+// Test para un pool de un hilo: parallelFor se ejecuta entero en el hilo que lo llama
+TEST(ThreadPoolTest, SingleThreadRunsOnCaller) {
+    ThreadPool pool(1);
+    const std::thread::id caller = std::this_thread::get_id();
+    std::atomic<int> elsewhere{0};
+    pool.parallelFor(100, [&](size_t) {
+        if (std::this_thread::get_id() != caller) { ++elsewhere; }
+    });
+    EXPECT_EQ(elsewhere.load(), 0);
+}
+
+// Test para la opción --threads: se quita de los argumentos y fija el tamaño del pool compartido
+TEST(ThreadPoolTest, ThreadsOption) {
+    std::vector<std::string> args = {"imtool-soa", "--threads", "3", "in.ppm", "out.ppm", "maxlevel", "100"};
+    ASSERT_TRUE(takeThreadsOption(args));
+    EXPECT_EQ(args, (std::vector<std::string>{"imtool-soa", "in.ppm", "out.ppm", "maxlevel", "100"}));
+    EXPECT_EQ(sharedThreadPool().size(), 3);
+    for (const std::string count : {"0", "-2", "abc", "123456"}) {
+        std::vector<std::string> invalid = {"imtool-soa", "in.ppm", "out.ppm", "maxlevel", "100", "--threads", count};
+        EXPECT_FALSE(takeThreadsOption(invalid));
+    }
+    std::vector<std::string> missing = {"imtool-soa", "in.ppm", "--threads"};
+    EXPECT_FALSE(takeThreadsOption(missing));
+    setSharedThreadCount(0);
+    EXPECT_EQ(sharedThreadPool().size(), defaultThreadCount());
+}
+
+// Test para maxlevel en paralelo: el resultado no depende del número de hilos
+TEST(ThreadPoolTest, MaxLevelIsDeterministic) {
+    const PPMMetadata metadata{.magicNumber = "P6", .width = 700, .height = 900, .maxColorValue = 255};
+    std::vector<std::vector<uint16_t>> results;
+    for (const size_t threads : {size_t{1}, size_t{2}, size_t{5}}) {
+        setSharedThreadCount(threads);
+        ImageSOA_8bit image(metadata);
+        for (size_t i = 0; i < image.gRed().size(); ++i) {
+            image.gRed()[i] = static_cast<uint8_t>(i * 7);
+            image.gGreen()[i] = static_cast<uint8_t>(i / 5);
+            image.gBlue()[i] = static_cast<uint8_t>(i ^ 0x5AU);
+        }
+        image.maxLevel(200);
+        auto const wide = image.maxLevelChangeChannelSize(1000);
+        results.push_back(wide->gRed());
+        results.back().insert(results.back().end(), wide->gBlue().begin(), wide->gBlue().end());
+    }
+    setSharedThreadCount(0);
+    EXPECT_EQ(results[0], results[1]);
+    EXPECT_EQ(results[0], results[2]);
+}
+
+// Test para forEachRowBand: cada fila de cada canal se visita una vez y las bandas respetan la
+// alineación pedida
+TEST(ThreadPoolTest, RowBandsCoverEveryRow) {
+    ThreadPool pool(3);
+    const RowBands shape = {.width = 100, .height = 1000, .channels = 2, .minSamples = 1, .rowAlign = 64};
+    std::vector<std::atomic<int>> visits(shape.channels * shape.height);
+    std::atomic<bool> aligned = true;
+    forEachRowBand(pool, shape, [&](size_t channel, size_t first, size_t end) {
+        if (first % shape.rowAlign != 0 || (end != shape.height && end % shape.rowAlign != 0)) {
+            aligned = false;
+        }
+        for (size_t row = first; row < end; ++row) { ++visits[(channel * shape.height) + row]; }
+    });
+    EXPECT_TRUE(aligned);
+    for (const auto& count : visits) { EXPECT_EQ(count, 1); }
+}
+
+// Test para resize en paralelo: el resultado no depende del número de hilos, en ninguna
+// disposición ni precisión
+TEST(ThreadPoolTest, ResizeIsDeterministic) {
+    const PPMMetadata metadata{.magicNumber = "P6", .width = 500, .height = 300, .maxColorValue = 255};
+    for (const ChannelLayout layout : {ChannelLayout::rowMajor, ChannelLayout::tiled}) {
+        for (const ResizePrecision precision : {ResizePrecision::exact, ResizePrecision::fixedPoint}) {
+            std::vector<std::vector<uint8_t>> results;
+            for (const size_t threads : {size_t{1}, size_t{3}, size_t{8}}) {
+                setSharedThreadCount(threads);
+                ImageSOA_8bit image(metadata);
+                for (size_t i = 0; i < image.gRed().size(); ++i) {
+                    image.gRed()[i] = static_cast<uint8_t>(i * 7);
+                    image.gGreen()[i] = static_cast<uint8_t>(i / 5);
+                    image.gBlue()[i] = static_cast<uint8_t>(i ^ 0x5AU);
+                }
+                image.sLayout(layout);
+                image.sResizePrecision(precision);
+                image.resize({.width = 700, .height = 450});
+                results.push_back(image.gRed());
+                results.back().insert(results.back().end(), image.gBlue().begin(), image.gBlue().end());
+            }
+            EXPECT_EQ(results[0], results[1]);
+            EXPECT_EQ(results[0], results[2]);
+        }
+    }
+    setSharedThreadCount(0);
+}
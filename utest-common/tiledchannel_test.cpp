@@ -0,0 +1,71 @@
+#include "../imgsoa/imagesoa.hpp"
+#include "../imgsoa/tiledchannel.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+
+namespace {
+  // Imagen de 8 bits con un patrón que no se repite entre teselas
+  ImageSOA_8bit patternImage(size_t width, size_t height, ChannelLayout layout) {
+    ImageSOA_8bit image(
+      PPMMetadata{.magicNumber = "P6", .width = width, .height = height, .maxColorValue = 255});
+    for (size_t i = 0; i < width * height; ++i) {
+      image.gRed()[i] = static_cast<uint8_t>((i * 7) % 251);
+      image.gGreen()[i] = static_cast<uint8_t>((i / 3) % 13);
+      image.gBlue()[i] = static_cast<uint8_t>((i * 31) % 17);
+    }
+    image.sLayout(layout);
+    return image;
+  }
+}
+
+// Test para el recorrido de teselas: cubre toda la imagen y recorta las del borde
+TEST(TiledChannelTest, RegionsCoverImage) {
+    size_t covered = 0;
+    size_t tiles = 0;
+    forEachTileRegion(130, 65, [&](const TileRegion& region) {
+        covered += region.width * region.height;
+        ++tiles;
+    });
+    EXPECT_EQ(tiles, 6);
+    EXPECT_EQ(covered, 130 * 65);
+}
+
+// Test para la conversión de orden por filas a teselas y vuelta
+TEST(TiledChannelTest, RowMajorRoundTrip) {
+    constexpr size_t width = 150;
+    constexpr size_t height = 70;
+    std::vector<uint16_t> rowMajor(width * height);
+    for (size_t i = 0; i < rowMajor.size(); ++i) { rowMajor[i] = static_cast<uint16_t>(i); }
+    const TiledChannel<uint16_t> tiled(rowMajor, width, height);
+    EXPECT_EQ(tiled.at(149, 69), rowMajor[(69 * width) + 149]);
+    EXPECT_EQ(tiled.at(64, 1), rowMajor[width + 64]);
+    std::vector<uint16_t> back(width * height);
+    tiled.toRowMajor(back);
+    EXPECT_EQ(back, rowMajor);
+}
+
+// Test para resize con teselas: mismo resultado que el orden por filas
+TEST(TiledChannelTest, TiledResizeMatchesRowMajor) {
+    for (const Dimensions dim :
+         {Dimensions{.width = 31, .height = 200}, Dimensions{.width = 300, .height = 45}}) {
+        ImageSOA_8bit rows = patternImage(150, 100, ChannelLayout::rowMajor);
+        ImageSOA_8bit tiles = patternImage(150, 100, ChannelLayout::tiled);
+        rows.resize(dim);
+        tiles.resize(dim);
+        EXPECT_EQ(rows.gRed(), tiles.gRed());
+        EXPECT_EQ(rows.gGreen(), tiles.gGreen());
+        EXPECT_EQ(rows.gBlue(), tiles.gBlue());
+    }
+}
+
+// Test para cutfreq con teselas: mismo resultado que el orden por filas
+TEST(TiledChannelTest, TiledCutfreqMatchesRowMajor) {
+    ImageSOA_8bit rows = patternImage(150, 100, ChannelLayout::rowMajor);
+    ImageSOA_8bit tiles = patternImage(150, 100, ChannelLayout::tiled);
+    rows.reduceColors(40);
+    tiles.reduceColors(40);
+    EXPECT_EQ(rows.gRed(), tiles.gRed());
+    EXPECT_EQ(rows.gGreen(), tiles.gGreen());
+    EXPECT_EQ(rows.gBlue(), tiles.gBlue());
+}
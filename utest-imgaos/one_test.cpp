@@ -2,7 +2,10 @@
 #include "../imgaos/imageaos.hpp"
 #include <vector>
 #include <fstream>
+#include <iterator>
+#include <string>
 #include <cmath>
+#include <utility>
 
 static constexpr uint16_t doscientos = 200;
 static constexpr uint16_t doscincocincuenta= 250;
@@ -71,6 +74,43 @@ TEST(SaveAndLoadImageTest, SaveAndLoadPPMImage) {
     static_cast<void>(std::remove(filename.c_str()));  // Ignora explícitamente el valor de retorno
 }
 
+// Prueba para verificar que las muestras de 16 bits se guardan y cargan completas, en big-endian
+TEST(SaveAndLoadImageTest, SaveAndLoadSixteenBitImage) {
+    const std::string filename = "test_image16.ppm";
+    const PPMMetadata metadata = {.magicNumber = "P6", .width = 2, .height = 1, .maxColorValue = 65535};
+    const std::vector<Pixel16> pixels = {createPixel(0x1234, 300, 65535), createPixel(256, 1, 0xABCD)};
+
+    saveImage(filename, pixels, metadata);
+
+    std::ifstream file(filename, std::ios::binary);
+    const std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(contents.substr(contents.size() - 12, 2), std::string("\x12\x34", 2));
+    EXPECT_EQ(loadImage<Pixel16>(filename, metadata), pixels);
+    EXPECT_THROW(loadImage<Pixel8>(filename, metadata), std::runtime_error);
+
+    static_cast<void>(std::remove(filename.c_str()));  // Ignora explícitamente el valor de retorno
+}
+
+// Prueba para verificar que con Pixel8 las operaciones dan lo mismo que con Pixel16
+TEST(PixelTypeTest, EightBitPixelsMatchSixteenBit) {
+    static_assert(sizeof(Pixel8) == 3);
+    const PPMMetadata metadata = {.magicNumber = "P6", .width = 29, .height = 17, .maxColorValue = doscincocinco};
+    std::vector<Pixel8> pixels8(static_cast<size_t>(29 * 17));
+    std::vector<Pixel16> pixels16(pixels8.size());
+    for (size_t i = 0; i < pixels8.size(); ++i) {
+        pixels8[i] = Pixel8{.red = static_cast<uint8_t>((i * 7) % 5 * 50), .green = static_cast<uint8_t>(i % 3 * 100), .blue = static_cast<uint8_t>(i % 251)};
+        pixels16[i] = createPixel(pixels8[i].red, pixels8[i].green, pixels8[i].blue);
+    }
+    const auto widen = [](const std::vector<Pixel8>& narrow) {
+        std::vector<Pixel16> wide;
+        for (const Pixel8& pixel : narrow) { wide.push_back(createPixel(pixel.red, pixel.green, pixel.blue)); }
+        return wide;
+    };
+    EXPECT_EQ(widen(resizeImage(pixels8, metadata, 40, 9)), resizeImage(pixels16, metadata, 40, 9));
+    EXPECT_EQ(widen(removeLeastFrequentColors(pixels8, 20)), removeLeastFrequentColors(pixels16, 20));
+    EXPECT_EQ(widen(scaleIntensityTo<Pixel8>(pixels16, doscincocinco, cien)), scaleIntensityTo<Pixel16>(pixels8, doscincocinco, cien));
+}
+
 // Prueba para verificar la lectura de los metadatos de un archivo PPM
 TEST(GetPPMMetadataTest, ReadsPPMMetadata) {
     const std::string filename = "test_metadata.ppm";
@@ -104,6 +144,41 @@ TEST(RemoveLeastFrequentColorsTest, ReplacesLeastFrequentColors) {
     EXPECT_EQ(modifiedPixels[1], modifiedPixels[0]); // El píxel (200, 200, 200) debe ser reemplazado
 }
 
+// Prueba para verificar que el resize de punto fijo no se aleja más de 2 de resizeImage
+TEST(ResizeImageFixedTest, StaysWithinTwoOfResizeImage) {
+    for (const int maxValue : {255, 65535}) {
+        const PPMMetadata metadata = {.magicNumber = "P6", .width = 37, .height = 23, .maxColorValue = maxValue};
+        std::vector<Pixel> pixels(static_cast<size_t>(37 * 23));
+        for (size_t i = 0; i < pixels.size(); ++i) {
+            pixels[i] = createPixel(static_cast<uint16_t>((i * 7919) % static_cast<size_t>(maxValue + 1)),
+                                    static_cast<uint16_t>((i * 104729) % static_cast<size_t>(maxValue + 1)),
+                                    static_cast<uint16_t>((i * i) % static_cast<size_t>(maxValue + 1)));
+        }
+        for (const auto& [newWidth, newHeight] : {std::pair{80, 9}, std::pair{12, 50}}) {
+            const auto expected = resizeImage(pixels, metadata, newWidth, newHeight);
+            const auto fixed = resizeImageFixed(pixels, metadata, newWidth, newHeight);
+            ASSERT_EQ(fixed.size(), expected.size());
+            for (size_t i = 0; i < fixed.size(); ++i) {
+                EXPECT_LE(std::abs(fixed[i].red - expected[i].red), 2);
+                EXPECT_LE(std::abs(fixed[i].green - expected[i].green), 2);
+                EXPECT_LE(std::abs(fixed[i].blue - expected[i].blue), 2);
+            }
+        }
+    }
+}
+
+// Prueba para verificar que resampleImage con box promedia cada bloque de píxeles
+TEST(ResampleImageTest, BoxAveragesBlocks) {
+    const PPMMetadata metadata = {.magicNumber = "P6", .width = 4, .height = 2, .maxColorValue = 65535};
+    const std::vector<Pixel> pixels = {createPixel(0, 100, 65535), createPixel(10, 200, 65535), createPixel(20, 0, 0), createPixel(30, 0, 0),
+                                       createPixel(20, 300, 65535), createPixel(30, 400, 65535), createPixel(40, 0, 0), createPixel(50, 4, 0)};
+    const PPMMetadata newMetadata = {.magicNumber = "P6", .width = 2, .height = 1, .maxColorValue = 65535};
+    const auto resized = resampleImage(pixels, metadata, newMetadata, ResizeFilter::box);
+    ASSERT_EQ(resized.size(), 2);
+    EXPECT_EQ(resized[0], createPixel(15, 250, 65535));
+    EXPECT_EQ(resized[1], createPixel(35, 1, 0));
+}
+
 // Función  para ejecutar todos los tests
 GTEST_API_ int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
@@ -3,7 +3,9 @@
 //
 
 #include "../imgsoa/imagesoa.hpp"
+#include "../common/threadpool.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <filesystem>
 #include <iostream>
@@ -364,6 +366,56 @@ namespace {
     std::cout << "Test maxlevel lake-small-65535 finished in:" << time << '\n';
   }
 
+  // Throughput of maxlevel on a synthetic 8000x8000 image with 1, 2, 4... threads up to the
+  // hardware count
+  [[maybe_unused]] void test_maxlevelThreads() {
+    constexpr size_t side      = 8000;
+    constexpr uint newMaxColor = 100;
+    PPMMetadata const metadata = {
+      .magicNumber = "P6", .width = side, .height = side, .maxColorValue = MAX_8BIT_VALUE};
+    auto const image       = std::make_unique<ImageSOA_8bit>(metadata);
+    double const megabytes = static_cast<double>(3 * side * side) / 1e6;
+    for (size_t threads = 1;; threads = std::min(threads * 2, defaultThreadCount())) {
+      setSharedThreadCount(threads);
+      image->sMaxColorValue(MAX_8BIT_VALUE);
+      auto const start = std::chrono::high_resolution_clock::now();
+      image->maxLevel(newMaxColor);
+      std::chrono::duration<double> const elapsed =
+        std::chrono::high_resolution_clock::now() - start;
+      std::cout << "Test maxlevel " << threads << " threads: " << megabytes / elapsed.count()
+                << " MB/s" << '\n';
+      if (threads == defaultThreadCount()) { break; }
+    }
+    setSharedThreadCount(0);
+  }
+
+  // Throughput of resize on a synthetic 4000x4000 image with 1, 2, 4... threads up to the
+  // hardware count: a thumbnail-sized downscale and a 2x upscale, in both layouts
+  [[maybe_unused]] void test_resizeThreads() {
+    constexpr size_t side      = 4000;
+    PPMMetadata const metadata = {
+      .magicNumber = "P6", .width = side, .height = side, .maxColorValue = MAX_8BIT_VALUE};
+    for (ChannelLayout const layout : {ChannelLayout::rowMajor, ChannelLayout::tiled}) {
+      for (size_t const target : {size_t{256}, 2 * side}) {
+        for (size_t threads = 1;; threads = std::min(threads * 2, defaultThreadCount())) {
+          setSharedThreadCount(threads);
+          auto const image = std::make_unique<ImageSOA_8bit>(metadata);
+          image->sLayout(layout);
+          auto const start = std::chrono::high_resolution_clock::now();
+          image->resize({.width = target, .height = target});
+          std::chrono::duration<double> const elapsed =
+            std::chrono::high_resolution_clock::now() - start;
+          std::cout << "Test resize " << (layout == ChannelLayout::tiled ? "tiled " : "rows ")
+                    << target << " " << threads << " threads: "
+                    << static_cast<double>(3 * target * target) / 1e6 / elapsed.count()
+                    << " Msamples/s" << '\n';
+          if (threads == defaultThreadCount()) { break; }
+        }
+      }
+    }
+    setSharedThreadCount(0);
+  }
+
   [[maybe_unused]] void test_resize(std::string & time) {
     time = test_wrapper(test_resizeDeerLarge100);
     std::cout << "Test resize deer-large-100 finished in:" << time << '\n';
@@ -402,4 +454,6 @@ int main() {
   test_resize(time);
 
   test_maxlevel(time);
+  test_maxlevelThreads();
+  test_resizeThreads();
 }
\ No newline at end of file